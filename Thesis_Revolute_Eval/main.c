@@ -1,1424 +1,3704 @@
-// Author: Jason Tennyson
-// Date: 1-18-11
-// File: main.c
-//
-// This is the design for the revolute modules for Jason Tennyson's Thesis.
-// This design is made for a PSoC CY8C29466-24PXI.  It is to be used for evaluation
-// of functionality on a common PSoC evaluation board.
-//
-// Packet Structure
-// ----------------
-// START BYTE/START BYTE/SOURCE ID BYTE/DESTINATION ID BYTE/COMMAND TYPE/PARAM 1/.../PARAM N/END TRANSMIT
-
-#include <m8c.h>        	// Part-specific constants and macros.
-#include "PSoCAPI.h"    	// PSoC API definitions for all User Modules.
-#include "psocdynamic.h"	// Required for dynamically swapping configurations at run time.
-
-// These are declarations of all of the timer interrupts that are used for all configurations.
-#pragma interrupt_handler WAIT_NC_TIMEOUT_ISR
-#pragma interrupt_handler TX_01234_TIMEOUT_ISR
-#pragma interrupt_handler CHILD_1_TIMEOUT_ISR
-#pragma interrupt_handler CHILD_2_TIMEOUT_ISR
-#pragma interrupt_handler CHILD_3_TIMEOUT_ISR
-#pragma interrupt_handler CHILD_4_TIMEOUT_ISR
-#pragma interrupt_handler HELLO_TIMEOUT_1_ISR
-#pragma interrupt_handler HELLO_TIMEOUT_2_ISR
-#pragma interrupt_handler INIT_TIMEOUT_ISR
-
-// These defines are used as parameters of the configToggle function.  Passing one of
-// these identifiers to configToggle will put the chip in that device configuration.
-#define		WAIT						(1)
-#define		MY_RESPONSE					(2)
-#define 	RESPONSE_1					(3)
-#define 	RESPONSE_2					(4)
-#define 	RESPONSE_3					(5)
-#define 	RESPONSE_4					(6)
-#define		HELLO_MODE_1				(7)
-#define		HELLO_MODE_2				(8)
-#define		INITIALIZE					(9)
-#define		SERVO_COMM					(10)
-
-// These defines are used as comparisons to find what port the next module connected to.
-#define		PORT_A						('A')
-#define		PORT_B						('B')
-#define		PORT_C						('C')
-#define		PORT_D						('D')
-
-// These are used to select which port group we are looking at.  We have to do this in order
-// to listen on 4 different ports on a device that physically only allows 2 at a time.
-#define		PORTS_0_1					(0)
-#define		PORTS_2_3					(1)
-
-// These defines are used as transmission indicators for transmissions between PSoC controllers.
-#define		START_TRANSMIT				(252)	// Indicates the beginning of a transmission.
-#define		END_TRANSMIT				(253)	// Indicates the end of a transmission.
-#define		HELLO_BYTE					(200)	// Indicates master is ready to talk.
-#define		ID_ASSIGNMENT				(201)	// Indicates an ID assignment from the master.
-#define		ID_ASSIGN_OK				(202)	// Indicates an ID assignment is complete.
-#define		PING						(203)	// Indicates a ping message to or from the master.
-#define		CLEAR_CONFIG				(204)	// Indicates that the master is asking for a config clear.
-#define		CONFIG_CLEARED				(205)	// Indicates that a module has cleared its own config.
-#define		MASTER_ID					(0)		// The master node's ID.
-#define		DEFAULT_ID					(251)	// The ID that all modules start with.
-#define		BROADCAST					(254)	// The broadcast ID for all controllers and servos.
-
-// SERVO DEFINES
-// These numbers can all be found in the AX-12+ datasheet.
-// These defines cover the range of IDs these servos are capable of.
-#define		SERVO_ID_MIN				(0)		// This is the lowest servo ID possible.
-#define		SERVO_ID_MAX				(253)	// This is the highest servo ID possible.
-// These defines are servo transmission indicators.
-#define		SERVO_START					(255)	// This is the start byte for a servo transmission.
-// These defines are used to fill in the length parameter for a given command type.  These are the only
-// lengths used by this controller for servo configuration purposes.  It is worth noting that any type
-// and length of command can be issued from the master after configuration is complete.
-#define		READ_LENGTH					(4)		// This is the length value for all reads.
-#define		WRITE_LENGTH				(4)		// This is the length value for all writes.
-#define		PING_LENGTH					(2)		// This is the length value for a ping.
-#define		RESET_LENGTH				(2)		// This is the length value for a reset.
-// These defines are used to fill in the servo's EEPROM address parameter for a given command type.
-#define		ID_ADDRESS					(3)		// This is the address where servo ID is stored.
-#define		STATUS_RET_ADDRESS			(16)	// This is where the status return level is stored.
-// These defines are used to fill in the instruction we are using on the servo.
-#define		PING_SERVO					(1)		// This is the instruction number for ping.
-#define		READ_SERVO					(2)		// This is the instruction number for a read.
-#define		WRITE_SERVO					(3)		// This is the instruction number for a write.
-#define		RESET_SERVO					(6)		// This is the instruction to reset the servo EEPROM.
-// These defines cover all of the status return level possibilities.
-#define		STATUS_RET_NEVER			(0)		// Only respond to ping commands.
-#define		STATUS_RET_READ				(1)		// Only respond to read data commands (recommended).
-#define		STATUS_RET_ALL				(2)		// Respond to every command.
-
-// This is the number of attempts we make to contact the servo per sweep of attempts before
-// writing to its EEPROM in an attempt to alter settings that keep us from communicating.
-#define		SERVO_COMM_ATTEMPTS			(10)
-// This is the number of times we do a loop of SERVO_COMM_ATTEMPTS.  We would like this to be at least 2.
-// This is because we do an EEPROM write after the first unsuccessful loop of SERVO_COMM_ATTEMPTS.
-// If we don't then do at least one more loop, the EEPROM write was done for no reason.
-#define		SERVO_COMM_LOOPS			(2)
-// This is the number of timeout periods to wait through while the servo boots up (2 ms per period).
-#define		SERVO_BOOT_TIMEOUTS			(75)
-
-// This is the number of iterations we loop waiting for bytes to reset the timeout on a child response.
-// This will be the amount of iterations we do after the last byte has been received as well.
-#define		RESPONSE_ITERATIONS			(10)
-
-// This is the status return level, which is set to one of the possible status return values above.
-// We want the status return level to be return on read commands only so that we don't have garbage
-// return packets flying around every time we tell the servo to move.
-#define		STATUS_RET_LEVEL			(STATUS_RET_READ)
-
-// This function receives a mode identifier as a parameter and toggles the system configuration.
-void configToggle(int mode);
-// This function unloads all configurations.  This should only be needed at startup.
-void unloadAllConfigs(void);
-// This function unloads the configuration corresponding to the number passed to it.
-void unloadConfig(int config_num);
-// This function is a response to the master sending out a hello message.
-void sayHello(void);
-// This function looks for commands and returns 1 if a command has been read, 0 if not.
-int commandReady(void);
-// This function interprets the command that has just been read and performs an action accordingly.
-void takeAction(void);
-// This function responds to a ping.
-void pingResponse(void);
-// This function tells the master node that an ID assignment was completed on this module.
-void assignedID(void);
-// This function sends out an acknowledgement of a configuration reset.
-void configCleared(void);
-// This function listens for children and registers the port that they talk to.
-int childListen(void);
-// This function waits for a known child's response to a command to that child from the master.
-int childResponse(void);
-// This function does everything it can to find the servo attached to this controller.
-void servoFinder(void);
-// This function carries out the passed servo instruction.
-void servoInstruction(char id, char length, char instruction, char address, char value);
-// This function does a simple for loop to stall and make doubly sure that the transmission finished.
-// It is meant to be used as a definite amount of wait time after the transmission complete flag is set.
-void xmitWait(void);
-// This function is called to do nothing while we wait for the servo to boot up.
-void servoBootWait(void);
-// This function is used to wait for other controllers to find their servos while not
-// driving any pins (which would keep a child from talking to its servo).
-void servoConfigWait(void);
-
-char CHILD;		// Keeps track of where the child is connected.
-char ID;		// Stores the ID that the master gives this module.
-
-int CONFIGURED;	// Keeps track of whether or not this module has been configured by the master.
-int TIMEOUT;	// This flag is set if a timeout occurs.
-int STATE;		// This stores the ID of the currently-loaded configuration.
-int PORT_GROUP;	// This is the port group we are looking at for hello responses.
-
-char COMMAND_SOURCE;		// Stores who the current command is from.
-char COMMAND_DESTINATION;	// Stores who the current command is for.
-char COMMAND_TYPE;			// Stores the type of command that was just read.
-char COMMAND_PARAM;			// Stores a parameter that accompanies the command (if any).
-char COMMAND_LENGTH;		// Stores the length parameter of a servo command.
-char COMMAND_ERROR;			// Stores the error code of a servo command.
-
-char SERVO_ID;				// Stores the ID of the servo inside of this module.
-
-void main()
-{	
-	// Initial value assignment for variables of importance.
-	CHILD = 0;				// There is no child yet.
-	CONFIGURED = 0;			// This module is not configured yet.
-	TIMEOUT = 0;			// Set the timeout flag low to start.
-	COMMAND_PARAM = 0;		// There is no parameter yet.
-	STATE = 0;				// There is no state yet.
-	PORT_GROUP = PORTS_0_1;	// Start with this port group and alternate between all port groups.
-	ID = DEFAULT_ID;		// Set the ID of this controller to the default to start with.
-
-	M8C_EnableGInt;			// Turn on global interrupts for the transmission timeout timer.
-	
-	M8C_EnableIntMask(INT_MSK0,INT_MSK0_GPIO); // Activate GPIO ISR
-	
-	// Find the servo that is inside of this module.
-	servoFinder();
-	
-	// Loop and wait for commands.
-	while(1)
-	{	
-		if(commandReady())
-		{
-			// If the command is ready, take action.
-			takeAction();
-		}
-	}
-}
-
-// This function transmits a response to a hello command from the master.
-void sayHello(void)
-{	
-	configToggle(MY_RESPONSE);		// Switch to response mode.
-	
-	// Transmit a hello response to the master node.
-	TX_014_PutChar(START_TRANSMIT);	// Start byte one
-	TX_014_PutChar(START_TRANSMIT);	// Start byte two
-	TX_014_PutChar(ID);				// My ID (source)
-	TX_014_PutChar(MASTER_ID);		// Master ID (destination)
-	TX_014_PutChar(HELLO_BYTE);		// This is a hello command.
-	TX_014_PutChar(CHILD);			// Sends child port value, default 0.
-	TX_014_PutChar(END_TRANSMIT);	// This is the end of this transmission.
-	TX_014_PutChar(END_TRANSMIT);	// This is the end of this transmission.
-	
-	// Wait for the transmission to finish.
-	while(!(TX_014_bReadTxStatus() & TX_014_TX_COMPLETE));
-	
-	// Make completely sure we're done.
-	xmitWait();
-
-	configToggle(WAIT);				// Switch back to wait mode.
-}
-
-// This function receives a mode flag and switches the microcontroller to the
-// desired hardware configuration.
-void configToggle(int mode)
-{	
-	// Set the pins high and disconnect from the global bus.
-	// This keeps false start bits from happening while we swap configs.
-	PRT0DR |= 0b00011111;	// Set pins P00 through P04 high.
-	PRT0GS &= 0b11100000;	// Disconnect pins P00 through P04 from the global bus.
-	
-	// Unload the configuration of the current state.
-	// If there is no state, blindly wipe all configurations.
-	if(STATE)
-	{
-		unloadConfig(STATE);
-	}
-	else
-	{
-		unloadAllConfigs();
-	}
-	
-	// Go through the list of possible modes until we find the one that was passed in to us.
-	// Then, load that configuration and initialize whatever needs to be initialized.
-	if(mode == WAIT)
-	{
-		// Load the wait receiver configuration.  This is the receiver configuration used after
-		// initialization is complete.  It listens and forwards everything it hears.
-		LoadConfig_waiting();
-		
-		// Start the receivers.
-		WAIT_RECV_Start(WAIT_RECV_PARITY_NONE);
-		RX8_2_Start(RX8_2_PARITY_NONE);
-		
-		// Set the current state.
-		STATE = WAIT;
-	}
-	else if(mode == MY_RESPONSE)
-	{
-		// Load the transmitter configuration.  This is for transmitting messages on all ports.
-		LoadConfig_my_response();
-		
-		// Clear the timeout flag.
-		TIMEOUT = 0;
-		
-		// Start the transmitters.
-		TX_014_Start(TX_014_PARITY_NONE);	// Transmits on P00, P01, and P04.
-		TX_23_Start(TX_23_PARITY_NONE);		// Transmits on P02 and P03.
-		
-		TX_01234_TIMEOUT_EnableInt();		// Make sure interrupts are enabled.
-		TX_01234_TIMEOUT_Start();			// Start the timer.
-		
-		// Do nothing while we wait for one timeout period (1 ms).
-		// This is to allow everyone to get in the right configuration before talking.
-		while(!TIMEOUT) { }
-		
-		TX_01234_TIMEOUT_Stop();			// Stop the timer.
-		TIMEOUT = 0;						// Reset the timeout flag.
-	
-		// Set the current state.
-		STATE = MY_RESPONSE;
-	}
-	else if(mode == RESPONSE_1)
-	{
-		// Load the response wait on port 1.
-		LoadConfig_response1();
-		
-		// Clear the timeout flag.
-		TIMEOUT = 0;
-		
-		// Start listening for a response through child port 1.
-		CHILD_1_Start(CHILD_1_PARITY_NONE);
-		
-		CHILD_1_TIMEOUT_EnableInt();		// Make sure interrupts are enabled.
-		CHILD_1_TIMEOUT_Start();			// Start the timer.
-		
-		// Set the current state.
-		STATE = RESPONSE_1;
-	}
-	else if(mode == RESPONSE_2)
-	{
-		// Load the response wait on port 2.
-		LoadConfig_response2();
-		
-		// Clear the timeout flag.
-		TIMEOUT = 0;
-		
-		// Start listening for a response through child port 2.
-		CHILD_2_Start(CHILD_2_PARITY_NONE);
-		
-		CHILD_2_TIMEOUT_EnableInt();		// Make sure interrupts are enabled.
-		CHILD_2_TIMEOUT_Start();			// Start the timer.
-		
-		// Set the current state.
-		STATE = RESPONSE_2;
-	}
-	else if(mode == RESPONSE_3)
-	{
-		// Load the response wait on port 3.
-		LoadConfig_response3();
-		
-		// Clear the timeout flag.
-		TIMEOUT = 0;
-		
-		// Start listening for a response through child port 3.
-		CHILD_3_Start(CHILD_3_PARITY_NONE);
-		
-		CHILD_3_TIMEOUT_EnableInt();		// Make sure interrupts are enabled.
-		CHILD_3_TIMEOUT_Start();			// Start the timer.
-		
-		// Set the current state.
-		STATE = RESPONSE_3;
-	}
-	else if(mode == RESPONSE_4)
-	{
-		// Load the response wait on port 4.
-		LoadConfig_response4();
-		
-		// Clear the timeout flag.
-		TIMEOUT = 0;
-		
-		// Start listening for a response through child port 4.
-		CHILD_4_Start(CHILD_4_PARITY_NONE);
-		
-		CHILD_4_TIMEOUT_EnableInt();		// Make sure interrupts are enabled.
-		CHILD_4_TIMEOUT_Start();			// Start the timer.
-		
-		// Set the current state.
-		STATE = RESPONSE_4;
-	}
-	else if(mode == HELLO_MODE_1)
-	{
-		// Load the hello wait mode.  This is for listening on all ports for a hello response.
-		LoadConfig_hello1();
-		
-		// Clear the timeout flag.
-		TIMEOUT = 0;
-		
-		// The seemingly unnecessary brackets around each line are unfortunately needed.
-	
-		{
-		// Start listening for a response through child port 1.
-		HELLO_1_Start(HELLO_1_PARITY_NONE);
-		}
-		
-		{
-		// Start listening for a response through child port 2.
-		HELLO_2_Start(HELLO_2_PARITY_NONE);
-		}
-		
-		HELLO_TIMEOUT_1_EnableInt();	// Make sure interrupts are enabled.
-		HELLO_TIMEOUT_1_Start();		// Start the timer.
-		
-		// Set the current state.
-		STATE = HELLO_MODE_1;
-	}
-	else if(mode == HELLO_MODE_2)
-	{
-		// Load the hello wait mode.  This is for listening on all ports for a hello response.
-		LoadConfig_hello2();
-		
-		// Clear the timeout flag.
-		TIMEOUT = 0;
-		
-		// The seemingly unnecessary brackets around each line are unfortunately needed.
-		
-		{
-		// Start listening for a response through child port 3.
-		HELLO_3_Start(HELLO_3_PARITY_NONE);
-		}
-		
-		{
-		// Start listening for a response through child port 4.
-		HELLO_4_Start(HELLO_4_PARITY_NONE);
-		}
-		
-		HELLO_TIMEOUT_2_EnableInt();	// Make sure interrupts are enabled.
-		HELLO_TIMEOUT_2_Start();		// Start the timer.
-		
-		// Set the current state.
-		STATE = HELLO_MODE_2;
-	}
-	else if(mode == INITIALIZE)
-	{
-		// Load the configuration for initialization.  This config listens but does not forward.
-		LoadConfig_initial();
-		
-		// Clear the timeout flag.
-		TIMEOUT = 0;
-		
-		// Start the receiver.
-		INIT_RX_Start(INIT_RX_PARITY_NONE);
-		
-		INIT_TIMEOUT_EnableInt();	// Make sure interrupts are enabled.
-		INIT_TIMEOUT_Start();		// Start the timer.
-		
-		// Set the current state.
-		STATE = INITIALIZE;
-	}
-	else if(mode == SERVO_COMM)
-	{
-		// Load the configuration for servo communication.  This config only transmits on P00.
-		LoadConfig_servo_transmit();
-		
-		// Clear the timeout flag.
-		TIMEOUT = 0;
-		
-		// Start the transmitter.
-		SERVO_TX_Start(SERVO_TX_PARITY_NONE);
-	
-		// Set the current state.
-		STATE = SERVO_COMM;
-	}
-	
-	// If this module is configured, talk on all pins for potential children.
-	if(CONFIGURED)
-	{
-		PRT0GS |= 0b00011111;	// Connect all pins to the global bus.
-		PRT2DR &= 0b11111110;	// Turn on the LED (active low).
-	}
-	else
-	{
-		PRT0GS |= 0b00000001;	// Just connect pin 0;
-		PRT2DR |= 0b00000001;	// Turn off the LED (active low).
-	}
-}
-
-// This function tries to peek and see if a start byte has been written to the bus.
-// If there is no start byte, the function exits.  If a start byte is detected, the function
-// blocks and waits for the transmission to finish.
-int commandReady(void)
-{
-	int i = 0;			// This integer is used for looping through the remaining bytes of commands.
-	char tempByte = 0;	// This byte is used to store each byte for comparison as it comes in.
-	
-	// This conditional checks which configuration is loaded and uses the proper devices to
-	// read a transmission and store the important information from that transmission.
-	if(STATE == WAIT)
-	{	
-		// In wait mode, the only thing that progresses things forward is a master node transmission.
-		// With this being the case, we use a blocking operation to sit and wait for a byte.
-		tempByte = WAIT_RECV_cGetChar();
-		
-		// If a transmission has started for either a controller or a servo...
-		if(tempByte == START_TRANSMIT)
-		{
-			// While we keep reading start bytes, sit and spin.
-			while(tempByte == START_TRANSMIT)
-			{
-				tempByte = WAIT_RECV_cGetChar();
-			}
-			
-			// The tempByte variable contains the source ID.  If the source is good, store all bytes.
-			if(tempByte == MASTER_ID)
-			{
-				COMMAND_SOURCE = tempByte;
-				COMMAND_DESTINATION = WAIT_RECV_cGetChar();
-				COMMAND_TYPE = WAIT_RECV_cGetChar();
-				COMMAND_PARAM = WAIT_RECV_cGetChar();
-				
-				return 1;
-			}
-		}
-		else if(tempByte == SERVO_START)
-		{
-			// While we keep reading start bytes, sit and spin.
-			while(tempByte == SERVO_START)
-			{
-				tempByte = WAIT_RECV_cGetChar();
-			}
-			
-			// We assume (and hopefully rightly so) that this is a command from master.
-			COMMAND_SOURCE = MASTER_ID;
-			// The first parameter after the servo start is the destination.
-			COMMAND_DESTINATION = tempByte;
-			// The second parameter after the servo start is the command length.
-			// We don't need it to wait for the transmission to go through since the
-			// transmission goes through the chip with a delay of approximately 100 ns
-			// (it is already in and out by the time you read this byte).
-			tempByte = WAIT_RECV_cGetChar();
-			// Now we store the command type.  Depending on what the status return level
-			// is, we have special duties.
-			COMMAND_TYPE = WAIT_RECV_cGetChar();
-			
-			// This basically waits for the rest of the command to pass through.
-			for(i = 0; i < (tempByte - 1); i++)
-			{
-				WAIT_RECV_cGetChar();
-			}
-				
-			return 1;
-		}
-	}
-	else if(STATE == HELLO_MODE_1)
-	{
-		// Check all of the ports for a start byte.  Only one port will produce one.
-		if(HELLO_1_cReadChar() == START_TRANSMIT)
-		{		
-			CHILD = PORT_A;
-			
-			return 1;
-		}
-		else if(HELLO_2_cReadChar() == START_TRANSMIT)
-		{		
-			CHILD = PORT_B;
-			
-			return 1;
-		}
-	}
-	else if(STATE == HELLO_MODE_2)
-	{
-		// Check all of the ports for a start byte.  Only one port will produce one.
-		if(HELLO_3_cReadChar() == START_TRANSMIT)
-		{
-			CHILD = PORT_C;
-			
-			return 1;
-		}
-		else if(HELLO_4_cReadChar() == START_TRANSMIT)
-		{
-			CHILD = PORT_D;
-			
-			return 1;
-		}
-	}
-	else if(STATE == RESPONSE_1)
-	{
-		if(tempByte = CHILD_1_cReadChar())
-		{
-			if(tempByte == SERVO_START)				// We have a servo response coming.
-			{
-				// Burn through the rest of the start bytes and the servo length.
-				while(CHILD_1_cGetChar() == SERVO_START) { }
-				
-				// We store the length, since it is the next byte from the servo.
-				tempByte = CHILD_1_cGetChar();
-				
-				// This basically waits for the rest of the command to pass through.
-				for(i = 0; i < tempByte; i++)
-				{
-					CHILD_1_cGetChar();
-				}
-				
-				return 1;
-			}
-			else if (tempByte == START_TRANSMIT)	// We have a controller response coming.
-			{
-				// We simply wait for the end transmit indicator.
-				while(CHILD_1_cGetChar() != END_TRANSMIT) { }
-				
-				return 1;
-			}
-		}
-	}
-	else if(STATE == RESPONSE_2)
-	{
-		if(tempByte = CHILD_2_cReadChar())
-		{
-			if(tempByte == SERVO_START)				// We have a servo response coming.
-			{
-				// Burn through the rest of the start bytes and the servo length.
-				while(CHILD_2_cGetChar() == SERVO_START) { }
-				
-				// We store the length, since it is the next byte from the servo.
-				tempByte = CHILD_2_cGetChar();
-				
-				// This basically waits for the rest of the command to pass through.
-				for(i = 0; i < tempByte; i++)
-				{
-					CHILD_2_cGetChar();
-				}
-				
-				return 1;
-			}
-			else if (tempByte == START_TRANSMIT)	// We have a controller response coming.
-			{
-				// We simply wait for the end transmit indicator.
-				while(CHILD_2_cGetChar() != END_TRANSMIT) { }
-				
-				return 1;
-			}
-		}
-	}
-	else if(STATE == RESPONSE_3)
-	{
-		if(tempByte = CHILD_3_cReadChar())
-		{
-			if(tempByte == SERVO_START)				// We have a servo response coming.
-			{
-				// Burn through the rest of the start bytes and the servo length.
-				while(CHILD_3_cGetChar() == SERVO_START) { }
-				
-				// We store the length, since it is the next byte from the servo.
-				tempByte = CHILD_3_cGetChar();
-				
-				// This basically waits for the rest of the command to pass through.
-				for(i = 0; i < tempByte; i++)
-				{
-					CHILD_3_cGetChar();
-				}
-				
-				return 1;
-			}
-			else if (tempByte == START_TRANSMIT)	// We have a controller response coming.
-			{
-				// We simply wait for the end transmit indicator.
-				while(CHILD_3_cGetChar() != END_TRANSMIT) { }
-				
-				return 1;
-			}
-		}
-	}
-	else if(STATE == RESPONSE_4)
-	{
-		if(tempByte = CHILD_4_cReadChar())
-		{
-			if(tempByte == SERVO_START)				// We have a servo response coming.
-			{
-				// Burn through the rest of the start bytes and the servo length.
-				while(CHILD_4_cGetChar() == SERVO_START) { }
-				
-				// We store the length, since it is the next byte from the servo.
-				tempByte = CHILD_4_cGetChar();
-				
-				// This basically waits for the rest of the command to pass through.
-				for(i = 0; i < tempByte; i++)
-				{
-					CHILD_4_cGetChar();
-				}
-				
-				return 1;
-			}
-			else if (tempByte == START_TRANSMIT)	// We have a controller response coming.
-			{
-				// We simply wait for the end transmit indicator.
-				while(CHILD_4_cGetChar() != END_TRANSMIT) { }
-				
-				return 1;
-			}
-		}
-	}
-	else if(STATE == INITIALIZE)
-	{
-		if(INIT_RX_cReadChar() == SERVO_START)
-		{
-			// We officially have a transmission.
-			if(INIT_RX_cGetChar() == SERVO_START)
-			{
-				// If we definitely have a transmission starting, grab all bytes from the rx buffer
-				// and store them in the proper variables for actions to be taken later.
-				COMMAND_SOURCE = INIT_RX_cGetChar();
-				COMMAND_LENGTH = INIT_RX_cGetChar();
-				COMMAND_ERROR = INIT_RX_cGetChar();
-				COMMAND_PARAM = INIT_RX_cGetChar();
-				
-				return 1;
-			}
-		}
-	}
-	
-	return 0;
-}
-
-// This function interprets what has been read by the command ready function
-// and performs the appropriate action.
-void takeAction(void)
-{
-	int i = 0;							// An index variable for looping.
-	
-	if(COMMAND_TYPE == HELLO_BYTE)		// The master is probing for new modules.
-	{
-		if(!CONFIGURED)
-		{
-			// Announce this module's presence if not configured.
-			sayHello();
-		}
-		else if(!CHILD)
-		{
-			// Listen for children if we have none.
-			if(childListen())
-			{
-				// If a child was heard saying hello, forward the command with the port number added.
-				sayHello();
-			}
-		}
-		else if(CHILD)
-		{
-			// If you have a child established, listen to that child.
-			childResponse();
-		}
-	}
-	else if(COMMAND_TYPE == PING)		// The master is trying to find a module that is configured.
-	{
-		// If this is to me, act accordingly.
-		if(COMMAND_DESTINATION == ID)
-		{
-			// Ping back to the master.
-			pingResponse();
-		}
-		else if(COMMAND_DESTINATION > ID)
-		{
-			// If you have a child established, listen to that child.
-			childResponse();
-		}
-	}
-	else if(COMMAND_TYPE == ID_ASSIGNMENT)	// The master is assigning an ID to someone.
-	{
-		// If this is meant for me, change my ID.
-		if(COMMAND_DESTINATION == ID)
-		{
-			if((COMMAND_PARAM > MASTER_ID) && (COMMAND_PARAM < DEFAULT_ID))
-			{
-				// Assign this module the ID that has been passed by the master.
-				ID = COMMAND_PARAM;
-				
-				// This module is now configured.
-				CONFIGURED = 1;
-				
-				// If the servo ID doesn't match what we want, change it to match.
-				if(ID != SERVO_ID)
-				{
-					// These are our index variables for communication attempt timeouts.
-					int i;
-					int j;
-					
-					//while(ID != SERVO_ID)
-					
-					for(j = 0; j < SERVO_COMM_LOOPS; j++)
-					{	
-						// Send a request to change the servo ID to match the controller ID.
-						servoInstruction(SERVO_ID, WRITE_LENGTH, WRITE_SERVO, ID_ADDRESS, ID);
-					
-						// Try to read the servo's ID several times.
-						for(i = 0; i < SERVO_COMM_ATTEMPTS; i++)
-						{
-							// Send a request for the servo ID, which is presumably now equal to ID.
-							servoInstruction(BROADCAST, PING_LENGTH, PING_SERVO, 0, 0);
-							
-							// Wait for either a timeout or an indication that we want to exit the loop.
-							while(!TIMEOUT)
-							{
-								// If we have a command to interpret, read it.
-								if(commandReady())
-								{
-									if(!COMMAND_ERROR)
-									{
-										// If we have a valid servo ID, exit the loop.
-										if(COMMAND_SOURCE == ID)
-										{
-											// Set the timeout flag to exit the while loop.
-											TIMEOUT = 1;
-											// Set i such that the for loop is exited.
-											i = SERVO_COMM_ATTEMPTS;
-											// Set j such that we exit the outer loop as well.
-											j = SERVO_COMM_LOOPS;
-											// Store the ID value.
-											SERVO_ID = ID;
-										}
-									}
-								}
-							}
-						}
-					}	
-				}
-				
-				if(ID != SERVO_ID)
-				{
-					// Toggle back to normal wait mode.
-					configToggle(WAIT);
-				}
-				else
-				{
-					// Let the master node know that you got the ID assignment.
-					assignedID();
-				}
-			}
-		}
-		else if(COMMAND_DESTINATION > ID)
-		{
-			// Switch to listen to your child.
-			childResponse();
-		}
-	}
-	else if(COMMAND_TYPE == CLEAR_CONFIG)	// The master wants to clear one or all configurations.
-	{
-		// Only respond if this is directly to me and not a mass config clear.
-		if(COMMAND_DESTINATION == ID)
-		{
-			configCleared();	// Notify the master that I am clearing my config.
-		}
-		
-		// If this is meant for me, deconfigure.  Also, if a module ahead of you is
-		// getting deconfigured, you have no choice but to deconfigure as well to
-		// avoid errors on reconfiguration.
-		if((COMMAND_DESTINATION <= ID) || (COMMAND_DESTINATION == BROADCAST))
-		{
-			ID = DEFAULT_ID;	// Reset my ID to the default.
-			CONFIGURED = 0;		// I am no longer configured.
-			CHILD = 0;			// No one can depend on you anymore.
-		}
-//		else if(COMMAND_DESTINATION > ID)
-//		{
-//			// Switch to listen to your child.
-//			childResponse();
-//			// Switch back to wait for a master response.
-//			configToggle(WAIT);
-//		}
-//		Going to also have to take into account of this is my child.
-		
-		// Turn off the LED.
-		PRT2DR |= 0b00000001;
-	}
-	else if((COMMAND_TYPE == PING_SERVO) || (COMMAND_TYPE == READ_SERVO))
-	{
-		if(COMMAND_DESTINATION > ID)
-		{
-			// Allow the child response through.
-			childResponse();
-		}
-		else if(COMMAND_DESTINATION <= ID)
-		{
-			// Sit and spin while we wait for the transmission to start.
-			while(WAIT_RECV_cReadChar() != SERVO_START) { }
-			
-			// Reset the index variable.
-			i = 0;
-			
-			// Wait for the transmission to go through.
-			// If no chars are read for RESPONSE_ITERATIONS iterations, move on.
-			while(i < RESPONSE_ITERATIONS)
-			{
-				if(WAIT_RECV_cReadChar())
-				{
-					i = 0;
-				}
-				else
-				{
-					i++;
-				}
-			}
-		}
-	}
-}
-
-// This function sends out an acknowledgement of a configuration reset.
-void configCleared(void)
-{
-	configToggle(MY_RESPONSE);		// Switch to response mode.
-	
-	// Transmit a ping to everyone.
-	TX_014_PutChar(START_TRANSMIT);	// Start byte one
-	TX_23_PutChar(START_TRANSMIT);	// Start byte one
-	TX_014_PutChar(START_TRANSMIT);	// Start byte two
-	TX_23_PutChar(START_TRANSMIT);	// Start byte two
-	TX_014_PutChar(ID);				// My ID
-	TX_23_PutChar(ID);				// My ID
-	TX_014_PutChar(MASTER_ID);		// Destination ID (master)
-	TX_23_PutChar(MASTER_ID);		// Destination ID (master)
-	TX_014_PutChar(CONFIG_CLEARED);	// This is a ping response
-	TX_23_PutChar(CONFIG_CLEARED);	// This is a ping response
-	TX_014_PutChar(END_TRANSMIT);	// This is the end of this transmission
-	TX_23_PutChar(END_TRANSMIT);	// This is the end of this transmission
-	TX_014_PutChar(END_TRANSMIT);	// This is the end of this transmission
-	TX_23_PutChar(END_TRANSMIT);	// This is the end of this transmission
-	
-	// Wait for the transmission to finish.
-	while(!(TX_014_bReadTxStatus() & TX_014_TX_COMPLETE));
-	while(!(TX_23_bReadTxStatus() & TX_23_TX_COMPLETE));
-	
-	// Make completely sure we're done.
-	xmitWait();
-	
-	configToggle(WAIT);				// Switch back to wait for a master response.
-}
-
-// This function sends out a ping response for everyone to hear.
-void pingResponse(void)
-{
-	configToggle(MY_RESPONSE);		// Switch to response mode.
-	
-	// Transmit a ping to everyone.
-	TX_014_PutChar(START_TRANSMIT);	// Start byte one
-	TX_23_PutChar(START_TRANSMIT);	// Start byte one
-	TX_014_PutChar(START_TRANSMIT);	// Start byte two
-	TX_23_PutChar(START_TRANSMIT);	// Start byte two
-	TX_014_PutChar(ID);				// My ID
-	TX_23_PutChar(ID);				// My ID
-	TX_014_PutChar(MASTER_ID);		// Destination ID (master)
-	TX_23_PutChar(MASTER_ID);		// Destination ID (master)
-	TX_014_PutChar(PING);			// This is a ping response
-	TX_23_PutChar(PING);			// This is a ping response
-	TX_014_PutChar(END_TRANSMIT);	// This is the end of this transmission
-	TX_23_PutChar(END_TRANSMIT);	// This is the end of this transmission
-	TX_014_PutChar(END_TRANSMIT);	// This is the end of this transmission
-	TX_23_PutChar(END_TRANSMIT);	// This is the end of this transmission
-	
-	// Wait for the transmission to finish.
-	while(!(TX_014_bReadTxStatus() & TX_014_TX_COMPLETE));
-	while(!(TX_23_bReadTxStatus() & TX_23_TX_COMPLETE));
-	
-	// Make completely sure we're done.
-	xmitWait();
-	
-	configToggle(WAIT);				// Switch back to wait for a master response.
-}
-
-// This function blindly unloads all user configurations. This will be called once,
-// when the system initially has no known state.
-void unloadAllConfigs(void)
-{
-	UnloadConfig_waiting();
-	UnloadConfig_hello1();
-	UnloadConfig_hello2();
-	UnloadConfig_my_response();
-	UnloadConfig_response1();
-	UnloadConfig_response2();
-	UnloadConfig_response3();
-	UnloadConfig_response4();
-	UnloadConfig_initial();
-	UnloadConfig_servo_transmit();
-}
-
-// This function unloads the configuration corresponding to the config number passed to it.
-// We do this instead of unloadAllConfigs to cut down on set up time.
-void unloadConfig(int config_num)
-{
-	if(config_num == WAIT)
-	{
-		UnloadConfig_waiting();
-	}
-	else if(config_num == HELLO_MODE_1)
-	{
-		UnloadConfig_hello1();
-	}
-	else if(config_num == HELLO_MODE_2)
-	{
-		UnloadConfig_hello2();
-	}
-	else if(config_num == MY_RESPONSE)
-	{
-		UnloadConfig_my_response();
-	}
-	else if(config_num == RESPONSE_1)
-	{
-		UnloadConfig_response1();
-	}
-	else if(config_num == RESPONSE_2)
-	{
-		UnloadConfig_response2();
-	}
-	else if(config_num == RESPONSE_3)
-	{
-		UnloadConfig_response3();
-	}
-	else if(config_num == RESPONSE_4)
-	{
-		UnloadConfig_response4();
-	}
-	else if(config_num == INITIALIZE)
-	{
-		UnloadConfig_initial();
-	}
-	else if(config_num == SERVO_COMM)
-	{
-		UnloadConfig_servo_transmit();
-	}
-}
-
-// This function responds that an ID has been assigned to it.
-void assignedID(void)
-{
-	configToggle(MY_RESPONSE);		// Switch to response mode.
-	
-	// Transmit a ping to everyone.
-	TX_014_PutChar(START_TRANSMIT);	// Start byte one
-	TX_23_PutChar(START_TRANSMIT);	// Start byte one
-	TX_014_PutChar(START_TRANSMIT);	// Start byte two
-	TX_23_PutChar(START_TRANSMIT);	// Start byte two
-	TX_014_PutChar(ID);				// My ID
-	TX_23_PutChar(ID);				// My ID
-	TX_014_PutChar(MASTER_ID);		// Destination ID (master)
-	TX_23_PutChar(MASTER_ID);		// Destination ID (master)
-	TX_014_PutChar(ID_ASSIGN_OK);	// This is an assignment ack response
-	TX_23_PutChar(ID_ASSIGN_OK);	// This is an assignment ack response
-	TX_014_PutChar(END_TRANSMIT);	// This is the end of this transmission
-	TX_23_PutChar(END_TRANSMIT);	// This is the end of this transmission
-	TX_014_PutChar(END_TRANSMIT);	// This is the end of this transmission
-	TX_23_PutChar(END_TRANSMIT);	// This is the end of this transmission
-	
-	// Wait for the transmission to finish.
-	while(!(TX_014_bReadTxStatus() & TX_014_TX_COMPLETE));
-	while(!(TX_23_bReadTxStatus() & TX_23_TX_COMPLETE));
-	
-	// Make completely sure we're done.
-	xmitWait();
-	
-	configToggle(WAIT);				// Switch back to wait for a master response.
-}
-
-// This function listens for children and registers the port that they talk to.
-int childListen(void)
-{
-	if(PORT_GROUP == PORTS_0_1)
-	{
-		configToggle(HELLO_MODE_1);	// Switch to listen for hellos on ports 0 and 1.
-	}
-	else if(PORT_GROUP == PORTS_2_3)
-	{
-		configToggle(HELLO_MODE_2);	// Switch to listen for hellos on ports 2 and 3.
-	}
-	
-	// Wait to either hear a child or time out.
-	while(!TIMEOUT)
-	{		
-		if(commandReady())
-		{
-			return 1;
-		}
-	}
-	
-	if(PORT_GROUP == PORTS_0_1)
-	{
-		HELLO_TIMEOUT_1_Stop();		// Stop the timer.
-		PORT_GROUP = PORTS_2_3;		// Switch to the other group for the next pass.
-	}
-	else if(PORT_GROUP == PORTS_2_3)
-	{
-		HELLO_TIMEOUT_2_Stop();		// Stop the timer.
-		PORT_GROUP = PORTS_0_1;		// Switch to the other group for the next pass.
-	}
-	
-	TIMEOUT = 0;					// Clear the timeout flag.
-	
-	configToggle(WAIT);				// Switch back to wait for a master response.
-	
-	return 0;						// Return the result of our listening session.
-}
-
-// This function waits for a child response.
-int childResponse(void)
-{
-	int child_responded = 0;
-	
-	// Switch to the right port.
-	if(CHILD == PORT_A)
-	{
-		configToggle(RESPONSE_1);
-	}
-	else if(CHILD == PORT_B)
-	{
-		configToggle(RESPONSE_2);
-	}
-	else if(CHILD == PORT_C)
-	{
-		configToggle(RESPONSE_3);
-	}
-	else if(CHILD == PORT_D)
-	{
-		configToggle(RESPONSE_4);
-	}
-	
-	// Wait for a response or a timeout.
-	while((!child_responded) && (!TIMEOUT))
-	{
-		if(commandReady())
-		{
-			child_responded = 1;
-		}
-	}
-	
-	// Stop the right timer.
-	if(CHILD == PORT_A)
-	{
-		CHILD_1_TIMEOUT_Stop();
-	}
-	else if(CHILD == PORT_B)
-	{
-		CHILD_2_TIMEOUT_Stop();
-	}
-	else if(CHILD == PORT_C)
-	{
-		CHILD_3_TIMEOUT_Stop();
-	}
-	else if(CHILD == PORT_D)
-	{
-		CHILD_4_TIMEOUT_Stop();
-	}
-	
-	TIMEOUT = 0;					// Reset the timeout flag.
-	
-	configToggle(WAIT);				// Switch back to wait for a master response.
-	
-	return child_responded;
-}
-
-// This function is used to find the servo that is directly connected to this module's controller.
-// After the servo ID is found, the status return level is changed so that packets are only
-// returned for the desired status return level defined at the top of this file.
-void servoFinder(void)
-{				
-	// Index variables for incrementing and checking against the maximum servo comm attempts.
-	int i = 0;
-	int j = 0;
-	
-	int total_attempts = 0;
-	
-	// Integer used as a flag so that EEPROM writes aren't done more than once.
-	int flashWrite = 0;
-	
-	// Create a status return level variable and set it to an out of range value initially.
-	char status_return_level = 3;
-	
-	// Start with a servo ID of 255 (out of valid range).
-	SERVO_ID = SERVO_START;
-
-	// We have to wait for the servo to power up and get ready for communications.
-	servoBootWait();
-
-	// This for loop will loop SERVO_COMM_LOOPS number of times and ping the servo SERVO_COMM_ATTEMPTS
-	// number of times in each loop (unless stopped short due to early success).  If this fails for the
-	// first round of pings, a broadcast reset will be performed to reset the servo.  This is done
-	// because we assume that the baud rate is matching up, but the servo's return delay time is too
-	// fast for the controller to switch into receive mode to read the response.  The default return
-	// delay time is 500 microseconds. If we loop for SERVO_COMM_LOOPS number of times and still don't
-	// see anything, we assume that there is something is too wrong for us to fix.
-	for(j = 0; j < SERVO_COMM_LOOPS; j++)
-	{	
-		// Ping SERVO_COMM_ATTEMPTS times to try and extract the servo ID.
-		for(i = 0; i < SERVO_COMM_ATTEMPTS; i++)
-		{
-			// Send a ping out for any servo connected to me (will only be one).
-			servoInstruction(BROADCAST, PING_LENGTH, PING_SERVO, 0, 0);
-			
-			total_attempts++;
-			
-			// Wait for either a timeout or a valid servo ID (which will trigger a timeout).
-			while(!TIMEOUT)
-			{	
-				if(commandReady())
-				{
-					// If we read a source ID within the range, exit the loop.
-					if((COMMAND_SOURCE >= SERVO_ID_MIN) && (COMMAND_SOURCE <= SERVO_ID_MAX))
-					{	
-						// Exit this while loop by setting the timeout flag.
-						TIMEOUT = 1;
-						// Set the servo ID variable to where the ping came from.
-						SERVO_ID = COMMAND_SOURCE;
-						// Set the index variable such that the for loop exits.
-						i = SERVO_COMM_ATTEMPTS;
-						// Set the outer index variable to 2 to not attempt again for no reason.
-						j = SERVO_COMM_LOOPS;
-					}
-					else
-					{
-						// Exit this while loop and try to ping again.
-						TIMEOUT = 1;
-					}
-				}
-			}
-		}
-		
-		// If we didn't get a response and haven't written to the flash of the
-		// servo (first time through), send out a broadcast reset.
-		if((SERVO_ID == SERVO_START) && (!flashWrite))
-		{
-			// Set the flash write flag so that we only do this once per power cycle.
-			flashWrite = 1;
-			
-			// Send out a broadcast reset so that we know that the response time interval
-			// is large enough (default delay time for a servo is 500 microseconds).
-			servoInstruction(BROADCAST, RESET_LENGTH, RESET_SERVO, 0, 0);
-		}
-	}
-
-	// Reset flash write flag.
-	flashWrite = 0;
-	
-	// If we have a valid servo ID, set the status return level.  If we don't, just skip this
-	// because all hope is lost.
-	if(SERVO_ID < BROADCAST)
-	{
-		// This for loop will loop SERVO_COMM_LOOPS number of times and poll for the servo's status
-		// return level SERVO_COMM_ATTEMPTS number of times in each loop (unless stopped short due
-		// to early success).  If this fails for the first iteration, or we read a status return level
-		// other than what we want, we will attempt to write the desired status return level onto the servo.
-		for(j = 0; j < SERVO_COMM_LOOPS; j++)
-		{
-			// Attempt to read the status return level for the defined number of attempts.
-			for(i = 0; i < SERVO_COMM_ATTEMPTS; i++)
-			{
-				// Send a request for the servo's status return level.
-				servoInstruction(SERVO_ID, READ_LENGTH, READ_SERVO, STATUS_RET_ADDRESS, 1);
-				
-				// Wait for either a timeout or an indication that we want to exit the loop.
-				while(!TIMEOUT)
-				{
-					// If a valid command is ready, interpret it.
-					if(commandReady())
-					{
-						if(!COMMAND_ERROR)
-						{
-							// If the return level is equal to what is desired, store it.
-							if(COMMAND_PARAM == STATUS_RET_LEVEL)
-							{
-								// Set the timeout flag to exit the loop.
-								TIMEOUT = 1;
-								// Store the status return level.
-								status_return_level = COMMAND_PARAM;
-								// Set i so that we exit the for loop.
-								i = SERVO_COMM_ATTEMPTS;
-								// Set the outer loop's variable so that we don't loop again.
-								j = SERVO_COMM_LOOPS;
-							}
-							else
-							{	
-								// Set the timeout flag to exit the loop.
-								TIMEOUT = 1;
-							}
-						}
-					}
-				}
-			}
-		
-			// If we didn't get a good response and haven't written to the flash of the servo,
-			// force a change in the status return level with an EEPROM write.
-			if((status_return_level != STATUS_RET_LEVEL) && (!flashWrite))
-			{	
-				flashWrite = 1;
-				
-				// Try to force the return status to what we want.
-				servoInstruction(SERVO_ID, WRITE_LENGTH, WRITE_SERVO, STATUS_RET_ADDRESS, STATUS_RET_LEVEL);
-			}
-		}
-		
-		if(status_return_level != STATUS_RET_LEVEL)
-		{
-			// Break on purpose to show that the status return is not correct.
-			while(1) { }
-		}
-	}
-	else
-	{
-		// Purposely break the module to show that we did not resolve the communication with our servo.
-		while(1) { }
-	}
-
-//	if(total_attempts <= SERVO_COMM_ATTEMPTS)
-//	{
-//		PRT2DR &= 0b11111110;
-//	}
-//	else
-//	{
-//		PRT2DR |= 0b00000001;
-//	}
-//	
-//	while(1) { }
-	
-	// Wait for the other controllers to find their servos.
-	servoConfigWait();
-}
-
-// This function receives a destination, command length, instruction type, address, and value.
-// With these parameters, the function sends a packet to the communication bus.
-void servoInstruction(char id, char length, char instruction, char address, char value)
-{
-	char checksum;
-	
-	// Toggle into transmit mode.
-	configToggle(SERVO_COMM);
-	
-	// Calculate the checksum value for our servo communication.
-	checksum = 255-((id + length + instruction + address + value)%256);
-	
-	// Talk to the servo.
-	if(instruction == PING_SERVO)
-	{
-		SERVO_TX_PutChar(SERVO_START);	// Start byte one
-		SERVO_TX_PutChar(SERVO_START);	// Start byte two
-		SERVO_TX_PutChar(id);			// Servo ID
-		SERVO_TX_PutChar(length);		// The instruction length.
-		SERVO_TX_PutChar(instruction);	// The instruction to carry out.
-		SERVO_TX_PutChar(checksum);		// This is the checksum.
-	}
-	else
-	{
-		SERVO_TX_PutChar(SERVO_START);	// Start byte one
-		SERVO_TX_PutChar(SERVO_START);	// Start byte two
-		SERVO_TX_PutChar(id);			// Servo ID
-		SERVO_TX_PutChar(length);		// The instruction length.
-		SERVO_TX_PutChar(instruction);	// The instruction to carry out.
-		SERVO_TX_PutChar(address);		// The address to read/write from/to.
-		SERVO_TX_PutChar(value);		// The value to write or number of bytes to read.
-		SERVO_TX_PutChar(checksum);		// This is the checksum.
-	}
-	
-	// Wait for the transmission to finish.
-	while(!(SERVO_TX_bReadTxStatus() & SERVO_TX_TX_COMPLETE));
-	
-	// Make completely sure we're done.
-	xmitWait();
-	
-	// Switch back to wait for a servo response.
-	configToggle(INITIALIZE);
-}
-
-void xmitWait(void)
-{
-	int i;
-	
-	for(i = 0; i < 25; i++)
-	{
-		// Does nothing and wastes approximately 50 microseconds.
-	}
-}
-
-// This function wastes time while the servo that is attached to this controller boots up.
-// Once that happens, communications should happen quickly and reliably.  The estimated boot
-// time in testing was approximately 120 ms.
-void servoBootWait(void)
-{
-	int i = 0;					// Index integer used for looping.
-
-	configToggle(INITIALIZE);	// Switch to initialize mode to do this timeout routine.
-	
-	// Loop and wait for enough timeouts to happen before we talk to the servo.
-	for(i = 0; i < SERVO_BOOT_TIMEOUTS; i++)
-	{
-		while(!TIMEOUT) { }		// Do nothing while we wait for one timeout period.
-		TIMEOUT = 0;			// Reset the timeout flag.
-	}
-	
-	INIT_TIMEOUT_Stop();		// Stop the timeout timer.
-	TIMEOUT = 0;				// Clear the timeout flag.
-}
-
-// Sits and spins for the amount of time it takes for a worst case scenario for setup time
-// to take place.  This allows all other modules to initialize.
-void servoConfigWait(void)
-{
-	int i = 0;					// Index integer for looping purposes.
-	
-	configToggle(INITIALIZE);	// Switch to initialize mode to do this timeout routine.
-	
-	// For SERVO_COMM_ATTEMPTS*SERVO_COMM_LOOPS cycles, let the other controllers find
-	// their servos.  The reason we loop this many times is to allow for a possible worst
-	// case scenario of setup time to complete.
-	for(i = 0; i < (SERVO_COMM_ATTEMPTS*SERVO_COMM_LOOPS); i++)
-	{
-		while(!TIMEOUT) { }		// Do nothing while we wait for one timeout period.
-		TIMEOUT = 0;			// Reset the timeout flag.
-	}
-	
-	INIT_TIMEOUT_Stop();		// Stop the timer.
-	TIMEOUT = 0;				// Reset the timeout flag.
-
-	configToggle(WAIT);			// Switch to wait for the master node to speak to you.
-}
-
-// This timeout ISR is for waiting before a transmission is made from this module.
-// This is to give all the other modules a chance to set up and clear their buffers.
-// It is currently set so that there is 1 ms of down time between the last transmission
-// and this module's transmission.
-void TX_01234_TIMEOUT_ISR(void)
-{
-	TIMEOUT = 1;	// Set the timeout flag.
-	M8C_ClearIntFlag(INT_CLR0,TX_01234_TIMEOUT_INT_MASK);
-}
-
-// These are the ISRs for the hello response timeouts.
-void HELLO_TIMEOUT_1_ISR(void)
-{
-	TIMEOUT = 1;	// Set the timeout flag.
-	M8C_ClearIntFlag(INT_CLR0,HELLO_TIMEOUT_1_INT_MASK);
-}
-
-void HELLO_TIMEOUT_2_ISR(void)
-{
-	TIMEOUT = 1;	// Set the timeout flag.
-	M8C_ClearIntFlag(INT_CLR0,HELLO_TIMEOUT_2_INT_MASK);
-}
-
-// These remaining ISRs are for all the child timeout scenarios.
-void CHILD_1_TIMEOUT_ISR(void)
-{
-	TIMEOUT = 1;	// Set the timeout flag.
-	M8C_ClearIntFlag(INT_CLR0,CHILD_1_TIMEOUT_INT_MASK);
-}
-
-void CHILD_2_TIMEOUT_ISR(void)
-{
-	TIMEOUT = 1;	// Set the timeout flag.
-	M8C_ClearIntFlag(INT_CLR0,CHILD_2_TIMEOUT_INT_MASK);
-}
-
-void CHILD_3_TIMEOUT_ISR(void)
-{
-	TIMEOUT = 1;	// Set the timeout flag.
-	M8C_ClearIntFlag(INT_CLR0,CHILD_3_TIMEOUT_INT_MASK);
-}
-
-void CHILD_4_TIMEOUT_ISR(void)
-{
-	TIMEOUT = 1;	// Set the timeout flag.
-	M8C_ClearIntFlag(INT_CLR0,CHILD_4_TIMEOUT_INT_MASK);
-}
-
-void INIT_TIMEOUT_ISR(void)
-{
-	TIMEOUT = 1;	// Set the timeout flag.
-	M8C_ClearIntFlag(INT_CLR0,INIT_TIMEOUT_INT_MASK);
+// Author: Jason Tennyson
+// Date: 1-18-11
+// File: main.c
+//
+// This is the design for the revolute modules for Jason Tennyson's Thesis.
+// This design is made for a PSoC CY8C29466-24PXI.  It is to be used for evaluation
+// of functionality on a common PSoC evaluation board.
+//
+// Packet Structure
+// ----------------
+// START BYTE/START BYTE/SOURCE ID BYTE/DESTINATION ID BYTE/COMMAND TYPE/PARAM 1/.../PARAM N/END TRANSMIT
+
+#include <m8c.h>        	// Part-specific constants and macros.
+#include "PSoCAPI.h"    	// PSoC API definitions for all User Modules.
+#include "psocdynamic.h"	// Required for dynamically swapping configurations at run time.
+#include "protocol.h"		// The bus protocol definition shared with the master firmware.
+
+// These are declarations of all of the timer interrupts that are used for all configurations.
+#pragma interrupt_handler WAIT_NC_TIMEOUT_ISR
+#pragma interrupt_handler TX_01234_TIMEOUT_ISR
+#pragma interrupt_handler CHILD_1_TIMEOUT_ISR
+#pragma interrupt_handler CHILD_2_TIMEOUT_ISR
+#pragma interrupt_handler CHILD_3_TIMEOUT_ISR
+#pragma interrupt_handler CHILD_4_TIMEOUT_ISR
+#pragma interrupt_handler HELLO_TIMEOUT_1_ISR
+#pragma interrupt_handler INIT_TIMEOUT_ISR
+
+// This is the declaration of the GPIO interrupt used for hello listening.  A falling
+// start-bit edge on any child pin fires it, which is how all four child ports are
+// watched at once on a device that can only place two receivers at a time.
+#pragma interrupt_handler GPIO_ISR
+
+// These are declarations of the receive interrupts for every receiver that feeds the
+// RX ring buffer.  The receive interrupt vector of each receiver user module is pointed
+// at the matching handler below so that bytes are pulled out of the hardware the moment
+// they arrive, whether or not the main loop is busy.
+// This is the declaration of the transmit interrupt that drains the outgoing packet
+// buffer.  Both response transmitters are fed in lockstep from this one handler since
+// they always carry the same frame at the same baud rate.
+#pragma interrupt_handler TX_014_TX_ISR
+
+#pragma interrupt_handler WAIT_RECV_RX_ISR
+#pragma interrupt_handler INIT_RX_RX_ISR
+#pragma interrupt_handler CHILD_1_RX_ISR
+#pragma interrupt_handler CHILD_2_RX_ISR
+#pragma interrupt_handler CHILD_3_RX_ISR
+#pragma interrupt_handler CHILD_4_RX_ISR
+
+// These defines are used as parameters of the configToggle function.  Passing one of
+// these identifiers to configToggle will put the chip in that device configuration.
+#define		WAIT						(1)
+#define 	RESPONSE_1					(3)
+#define 	RESPONSE_2					(4)
+#define 	RESPONSE_3					(5)
+#define 	RESPONSE_4					(6)
+#define		HELLO_ALL					(7)
+#define		INITIALIZE					(9)
+#define		SERVO_COMM					(10)
+
+// These defines are used as comparisons to find what port the next module connected to.
+#define		PORT_A						('A')
+#define		PORT_B						('B')
+#define		PORT_C						('C')
+#define		PORT_D						('D')
+
+// The frame bytes, command codes, ack bits, and servo constants all live in
+// protocol.h, which the master firmware builds from as well.
+
+// This is how many fully parsed commands can sit waiting for dispatch.  Two slots are
+// enough for a second master command to arrive in one piece while a handler is still
+// working on the first.
+#define		CMD_QUEUE_SIZE				(2)
+
+// How many consecutive quiet main loop passes a faulted module waits between background
+// servo retries.  Long enough that a retry never collides with live traffic, short
+// enough that a servo coming back is picked up within seconds.
+#define		SERVO_RETRY_PASSES			(30000)
+
+// The identity cache lives at the bottom of the E2PROM block.  The magic byte marks a
+// cache written by a successful configuration; anything else means the cache is stale.
+#define		CACHE_ADDRESS				(0)		// Where the identity cache starts in the E2PROM.
+#define		CACHE_VALID					(90)	// The magic byte of a valid identity cache.
+
+// This is the number of attempts we make to contact the servo per sweep of attempts before
+// writing to its EEPROM in an attempt to alter settings that keep us from communicating.
+#define		SERVO_COMM_ATTEMPTS			(10)
+// This is the number of times we do a loop of SERVO_COMM_ATTEMPTS.  We would like this to be at least 2.
+// This is because we do an EEPROM write after the first unsuccessful loop of SERVO_COMM_ATTEMPTS.
+// If we don't then do at least one more loop, the EEPROM write was done for no reason.
+#define		SERVO_COMM_LOOPS			(2)
+// This is the maximum number of timeout periods to keep probing while the servo boots up
+// (2 ms per period).  The probe loop exits the moment the servo answers, so this cap is
+// only ever paid in full when no servo is attached at all.
+#define		SERVO_BOOT_TIMEOUTS			(75)
+
+// This is the number of iterations we loop waiting for bytes to reset the timeout on a child response.
+// This will be the amount of iterations we do after the last byte has been received as well.
+#define		RESPONSE_ITERATIONS			(10)
+
+// This is the number of empty passes we make over the ring buffer mid-frame before
+// deciding that a streamed frame was truncated and giving up on it.
+#define		STARVE_LIMIT				(10000)
+
+// The controller UARTs take their clock from VC2, which runs at eight times the baud
+// rate: SysClk 24 MHz through VC1 (divide by 13) and VC2 (divide by 4) gives 461.5 kHz,
+// which is 57.6k baud to within 0.16%.  Halving the VC2 divider doubles the rate, so
+// the tiers 0, 1, and 2 are 57.6k, 115.2k, and 230.4k with the same clock error at
+// every step.  OSC_CR1 holds both dividers, each stored as one less than its value.
+#define		VC1_DIVIDER					(13)	// Fixed; the servo leg's rate hangs off it too.
+#define		VC2_DIVIDER					(4)		// The tier-zero VC2 divider.
+#define		BAUD_TIER_MAX				(2)		// VC2 cannot divide by less than one.
+#define		BAUD_FALL_LIMIT				(3)		// Checksum failures at speed before falling back.
+
+// How many frames the bus trace ring holds.  Each entry is a millisecond timestamp plus
+// the frame's type, source, and length; the ring keeps the most recent frames.
+#define		TRACE_SIZE					(8)
+
+// The width of one response slot in a ping sweep, in microseconds.  It covers a response
+// packet, the transmit guard busTransmit() falls back on when no ready sentinel comes,
+// and margin for clock skew between modules.
+#define		SWEEP_SLOT_US				(4000)
+
+// This is the number of consecutive empty main loop passes before the core is put to
+// sleep.  Each pass is a handful of instructions, so this works out to a few tens of
+// milliseconds of bus silence -- long enough that no mid-exchange gap ever trips it.
+#define		IDLE_LIMIT					(20000)
+
+// These run the round trip stopwatch.  While a measurement is in flight the child
+// timeout timer free-runs at a fine period and its interrupt counts ticks instead of
+// declaring a timeout, so the measured figure is exactly the window the timeout period
+// is supposed to cover: listener up to response complete.
+#define		MEASURE_PERIOD				(150)	// The stopwatch period: 50 microseconds in ticks.
+#define		MEASURE_LIMIT				(400)	// The tick cap; 20 milliseconds means nobody answered.
+
+// The timeout timer blocks count the 3 MHz VC3 clock, so these convert between time and
+// timer ticks.  The default period is the one millisecond guard the timers have always
+// used; delayUs() borrows the transmit timeout timer and always puts this period back.
+#define		TICKS_PER_US				(3)		// Timer ticks in one microsecond.
+#define		TX_TIMEOUT_PERIOD			(3000)	// The standard one millisecond period, in ticks.
+
+// These run the telemetry subscription.  The epoch length comes from the master in the
+// TELEMETRY command parameter, in milliseconds of the telemetry tick; each module owns
+// a slot inside the epoch staggered by its ID, wide enough for two one-byte servo reads
+// plus the report and the transmit guard.
+#define		TELEM_SLOT_MS				(4)		// How many milliseconds one reporting slot gets.
+#define		TELEM_LENGTH				(4)		// The length byte of a position report packet.
+
+// One bit-time at 57,600 baud is about 17.4 microseconds.  The guard after a transmit
+// complete flag is exactly one stop bit of margin, rounded up to a whole microsecond.
+#define		TX_TAIL_US					(18)
+
+// This is the size of the receive ring buffer that the receive interrupts fill.  It must be
+// a power of two so that the wrap-around can be done with a cheap mask instead of a modulo.
+// The longest frame we ever relay is well under this size, so the buffer gives us a full
+// frame of slack before the main loop has to come around and drain it.
+#define		RX_BUFFER_SIZE				(32)
+#define		RX_BUFFER_MASK				(RX_BUFFER_SIZE - 1)
+
+// This is the size of the outgoing packet buffer that the transmit interrupt drains.
+// It only ever has to hold one controller frame, which is well under this size.
+#define		TX_BUFFER_SIZE				(16)
+
+// These defines are the states of the byte-wise packet parser that commandReady() runs
+// over the ring buffer.  The parser picks up exactly where it left off every time another
+// byte arrives, so a frame that trickles in over several main loop passes is no problem.
+#define		PARSE_IDLE					(0)		// Waiting for a start byte of either flavor.
+#define		PARSE_SOURCE				(1)		// Controller frame, waiting for the source ID.
+#define		PARSE_DESTINATION			(2)		// Controller frame, waiting for the destination ID.
+#define		PARSE_TYPE					(3)		// Controller frame, waiting for the command type.
+#define		PARSE_LENGTH				(4)		// Controller frame, waiting for the length byte.
+#define		PARSE_SERVO_DEST			(5)		// Servo frame, waiting for the destination ID.
+#define		PARSE_SERVO_LENGTH			(6)		// Servo frame, waiting for the length byte.
+#define		PARSE_SERVO_TYPE			(7)		// Servo frame, waiting for the instruction byte.
+#define		PARSE_SERVO_BURN			(8)		// Servo frame, letting the remaining bytes pass.
+#define		PARSE_INIT_START			(9)		// Servo status frame, waiting for start byte two.
+#define		PARSE_INIT_SOURCE			(10)	// Servo status frame, waiting for the source ID.
+#define		PARSE_INIT_LENGTH			(11)	// Servo status frame, waiting for the length byte.
+#define		PARSE_INIT_ERROR			(12)	// Servo status frame, waiting for the error byte.
+#define		PARSE_INIT_PARAM			(13)	// Servo status frame, waiting for the parameter.
+#define		PARSE_RESP_SERVO_SKIP		(14)	// Child servo response, skipping starts and the ID.
+#define		PARSE_RESP_SERVO_LENGTH		(15)	// Child servo response, waiting for the length byte.
+#define		PARSE_RESP_SERVO_BURN		(16)	// Child servo response, letting the payload pass.
+#define		PARSE_RESP_CTRL_END			(17)	// Child controller response, waiting for the end byte.
+#define		PARSE_CHECKSUM				(18)	// Controller frame, waiting for the checksum byte.
+#define		PARSE_RESP_CTRL_SOURCE		(19)	// Child controller response, waiting for the source ID.
+#define		PARSE_RESP_CTRL_DEST		(20)	// Child controller response, waiting for the destination.
+#define		PARSE_RESP_CTRL_TYPE		(21)	// Child controller response, waiting for the type byte.
+#define		PARSE_RESP_CTRL_LENGTH		(22)	// Child controller response, waiting for the length.
+#define		PARSE_RESP_CTRL_CHECK		(23)	// Child controller response, waiting for the checksum.
+#define		PARSE_PAYLOAD				(24)	// Controller frame, collecting the payload bytes.
+#define		PARSE_RESP_CTRL_PAYLOAD		(25)	// Child controller response, collecting the payload.
+
+// This is the status return level, which is set to one of the possible status return values above.
+// We want the status return level to be return on read commands only so that we don't have garbage
+// return packets flying around every time we tell the servo to move.
+#define		STATUS_RET_LEVEL			(STATUS_RET_READ)
+
+// This is the function pointer type that the dispatch tables below are built from.
+// Every table entry is a routine that takes nothing and returns nothing.
+typedef void (*actionFunc)(void);
+
+// This function receives a mode identifier as a parameter and toggles the system configuration.
+void configToggle(int mode);
+// This function flips the half-duplex bus pins from receive to transmit.  The response
+// transmitters are resident in every configuration, so this is just a pin routing change.
+void busTransmit(void);
+// This function flips the half-duplex bus pins from transmit back to receive once the
+// last byte has cleared the wire.
+void busReceive(void);
+// This function hands a prebuilt frame to the transmit interrupt, which drains it to the
+// response transmitters in the background while the CPU goes back to other work.
+void sendPacket(char *packet, int length);
+// This function fires the config-ready sentinel at a child that is about to respond.
+void signalReady(void);
+// This function unloads all configurations.  This should only be needed at startup.
+void unloadAllConfigs(void);
+// This function unloads the configuration corresponding to the number passed to it.
+void unloadConfig(int config_num);
+// This function is a response to the master sending out a hello message.
+void sayHello(void);
+// This function computes the checksum byte for a controller frame body.
+char frameChecksum(char source, char dest, char type, char length, char param);
+// This function looks for commands and returns 1 if a command has been read, 0 if not.
+int commandReady(void);
+// This function files a completed frame into the command queue.
+int framePush(void);
+// This function returns 1 if the receive ring buffer holds at least one unread byte.
+int rxBytesReady(void);
+// This function pulls the oldest unread byte out of the receive ring buffer.
+char rxGetByte(void);
+// This function throws away everything in the receive ring buffer and resets the parser.
+void rxFlush(void);
+// This function runs one byte through the packet parser state machine.  It returns 1 the
+// moment the byte completes a command, 0 otherwise.
+int parseByte(char newByte);
+// This function interprets the command that has just been read and performs an action accordingly.
+void takeAction(void);
+// These functions are the per-command handlers that takeAction() dispatches to.
+void helloAction(void);			// Handles a hello from the master.
+void pingAction(void);			// Handles a ping from the master.
+void idAssignAction(void);		// Handles an ID assignment from the master.
+void clearConfigAction(void);	// Handles a configuration clear from the master.
+void servoRelayAction(void);	// Handles a servo command passing along the chain.
+void syncMoveAction(void);		// Handles a batched sync-move frame from the master.
+void resumeAction(void);		// Handles a warm restart offer from the master.
+void readStatsAction(void);		// Handles a performance counter read from the master.
+void ackAction(void);			// Handles an aggregated acknowledgment sweep.
+void telemetryAction(void);		// Handles a telemetry subscription change from the master.
+void renumberAction(void);		// Handles an in-place renumbering sweep from the master.
+void setBaudAction(void);		// Handles a bus rate tier change from the master.
+void sweepPingAction(void);		// Handles a whole-chain ping sweep from the master.
+void setTraceAction(void);		// Handles arming or disarming the bus trace recorder.
+void readTraceAction(void);		// Handles reading one trace entry back to the master.
+void measureAction(void);		// Handles a child round trip measurement for the master.
+void setTimeoutAction(void);	// Handles a child timeout period change from the master.
+// This function closes the hardware pass-through route for downstream servo traffic and
+// holds it until the line goes idle.
+void passThrough(void);
+// This function watches an already-closed pass-through route and reopens it on quiet.
+void routeWatch(void);
+// This function commits this module's identity to flash after a successful configuration.
+void cacheStore(void);
+// This function invalidates the cached identity in flash.
+void cacheClear(void);
+// This function bumps a performance counter without letting it wrap.
+void statBump(int stat);
+// This function sends one performance counter value back to the master.
+void statsResponse(char value);
+// This function sends the aggregated acknowledgment byte upstream.
+void ackResponse(char status);
+// This function files one completed frame into the trace ring.
+void traceFrame(void);
+// This function sends one trace ring entry upstream as a multi-byte payload.
+void traceResponse(char index);
+// This function fires a master-shaped ping at this module's child.
+void measureProbe(char childID);
+// This function sends a measured round trip upstream as a two-byte payload.
+void measureResponse(int ticks);
+// This function sends this epoch's position report when our time slot comes up.
+void telemetryPoll(void);
+// This function puts the core to sleep once the bus has been quiet for a while.
+void idleSleep(void);
+// This function retries a faulted servo in the background between packets.
+void servoRecover(void);
+// This function programs the clock dividers for a controller bus rate tier.
+void applyBaudTier(char tier);
+// This function counts a checksum failure at speed and falls back when they pile up.
+void tierError(void);
+// This function pushes one present position report upstream.
+void telemetryReport(char posLow, char posHigh);
+// This function responds to a ping.
+void pingResponse(void);
+// This function tells the master node that an ID assignment was completed on this module.
+void assignedID(void);
+// This function sends out an acknowledgement of a configuration reset.
+void configCleared(void);
+// This function originates a hello on the master's behalf at whoever is listening.
+void helloProbe(void);
+// This function listens for children and registers the port that they talk to.
+int childListen(void);
+// This function probes the child ports for the next module as soon as our own ID
+// assignment completes, pipelining discovery with the master's upstream assignments.
+void childProbe(void);
+// This function repeats a known child's response upstream without touching the bytes.
+int childResponse(void);
+// This function waits for a known child's response and parses it for local use.
+int childCollect(void);
+// This function is the common skeleton behind childResponse() and childCollect().
+int childWait(int repeat);
+// This function is the interrupt-side byte counter behind the response repeater.
+void repeatByte(char newByte);
+// This function checks a frame's length byte against the shared protocol table.
+int lengthOk(char type, char length);
+// This function does everything it can to find the servo attached to this controller.
+void servoFinder(void);
+// This function blasts one instruction frame at the servo bus and returns.
+void servoTransmit(char id, char length, char instruction, char address, char value);
+// This function fires a register write at the servo without waiting for a response.
+void servoWrite(char id, char address, char value);
+// This function fires a register read at the servo and arms the receiver for the answer.
+void servoRead(char id, char address, char count);
+// This function carries out the passed servo instruction and waits for the response.
+void servoInstruction(char id, char length, char instruction, char address, char value);
+// This function writes a goal position and moving speed to our servo in one instruction.
+void servoMove(char posLow, char posHigh, char speedLow, char speedHigh);
+// This function parks the CPU for the passed number of microseconds on a hardware timer.
+void delayUs(int microseconds);
+// This function waits out one stop-bit margin after the transmission complete flag is set.
+void xmitWait(void);
+// This function probes the servo at short intervals while it boots up and returns as soon
+// as it answers.
+void servoBootWait(void);
+// This function is used to wait for the chain to come ready while not driving any pins
+// (which would keep a child from talking to its servo).
+void servoConfigWait(void);
+
+char CHILD;		// Keeps track of where the child is connected.
+char ID;		// Stores the ID that the master gives this module.
+
+int CONFIGURED;	// Keeps track of whether or not this module has been configured by the master.
+int TIMEOUT;	// This flag is set if a timeout occurs.
+int STATE;		// This stores the ID of the currently-loaded configuration.
+
+char HELLO_PORT;	// Set by the GPIO interrupt to the port that saw a start-bit edge.
+
+char COMMAND_SOURCE;		// Stores who the current command is from.
+char COMMAND_DESTINATION;	// Stores who the current command is for.
+char COMMAND_TYPE;			// Stores the type of command that was just read.
+char COMMAND_PARAM;			// Stores a parameter that accompanies the command (if any).
+char COMMAND_LENGTH;		// Stores the length byte of a servo or controller command.
+char COMMAND_PAYLOAD[PAYLOAD_MAX];	// Stores the payload of a controller command.
+char COMMAND_ERROR;			// Stores the error code of a servo command.
+
+char SERVO_ID;				// Stores the ID of the servo inside of this module.
+
+char RX_BUFFER[RX_BUFFER_SIZE];	// The ring buffer that the receive interrupts fill.
+int RX_WRITE;				// The ring buffer index that the receive interrupts write to.
+int RX_READ;				// The ring buffer index that the main loop reads from.
+
+char TX_BUFFER[TX_BUFFER_SIZE];	// The outgoing frame that the transmit interrupt drains.
+int TX_INDEX;				// The index of the byte currently in the transmit hardware.
+int TX_LENGTH;				// The total length of the outgoing frame.
+int TX_BUSY;				// Set while the transmit interrupt is still draining a frame.
+
+int PARSE_STATE;			// The current state of the packet parser state machine.
+int PARSE_COUNT;			// Counts pass-through bytes remaining in the current frame.
+int PARSE_SUM;				// Running sum of the controller frame body for the checksum.
+int COMMAND_FORWARD;		// Set when the destination byte already routed the frame downstream.
+
+// These are the parser's staging copies of the frame fields.  The parser accumulates
+// into these while a frame is on the wire and files a snapshot into the command queue
+// when the frame completes, so a frame arriving mid-dispatch cannot clobber the command
+// a handler is still working from.
+char FRAME_SOURCE;			// The source ID of the frame being parsed.
+char FRAME_DEST;			// The destination ID of the frame being parsed.
+char FRAME_TYPE;			// The type byte of the frame being parsed.
+char FRAME_PARAM;			// The parameter byte of the frame being parsed.
+char FRAME_LENGTH;			// The length byte of the frame being parsed.
+char FRAME_PAYLOAD[PAYLOAD_MAX];	// The payload bytes of the controller frame being parsed.
+char FRAME_ERROR;			// The error byte of the servo frame being parsed.
+int FRAME_FORWARD;			// Set when this frame's destination byte already routed it.
+
+// This is the command queue the parser fills and commandReady() drains, as parallel
+// arrays indexed the same way the receive ring buffer is.
+char CMD_SOURCE[CMD_QUEUE_SIZE];	// Queued source IDs.
+char CMD_DEST[CMD_QUEUE_SIZE];		// Queued destination IDs.
+char CMD_TYPE[CMD_QUEUE_SIZE];		// Queued type bytes.
+char CMD_PARAM[CMD_QUEUE_SIZE];		// Queued parameter bytes.
+char CMD_LENGTH[CMD_QUEUE_SIZE];	// Queued length bytes.
+char CMD_PAYLOAD[CMD_QUEUE_SIZE][PAYLOAD_MAX];	// Queued controller payloads.
+char CMD_ERROR[CMD_QUEUE_SIZE];		// Queued servo error bytes.
+char CMD_FORWARD[CMD_QUEUE_SIZE];	// Queued forward flags.
+int CMD_HEAD;				// Where the parser files the next completed frame.
+int CMD_TAIL;				// Where commandReady() pops the oldest one.
+int CMD_COUNT;				// How many commands are waiting.
+
+// This table holds the expected payload length of every controller command, expanded
+// straight from the shared protocol list, so the parser can length-check a frame before
+// its payload even arrives.  A mismatched master build is rejected at the length byte
+// instead of being misread at dispatch.
+#define PROTOCOL_COMMAND(name, code, length)	(length),
+const char COMMAND_LENGTHS[COMMAND_COUNT] = { PROTOCOL_COMMANDS };
+#undef PROTOCOL_COMMAND
+
+char STATS[STAT_COUNT];		// The performance counters, indexed by the STAT_ defines.
+char MODULE_STATUS;			// Status bits this module will fold into the next aggregated ack.
+
+int IDLE_COUNT;				// Consecutive empty main loop passes since the last activity.
+
+// These drive the child response repeater.  While a response configuration is loaded the
+// hardware row already carries the child's bytes upstream; the receive interrupts only
+// count bytes to find the end of the frame, and the main loop just waits on the flag.
+char RESP_REPEAT;			// Nonzero while the interrupts are counting instead of buffering.
+char RESP_COUNT;			// How many bytes of the child's frame have gone by.
+char RESP_EXPECT;			// How long the frame will be, once its header has said.
+char RESP_DONE;				// Set by the interrupt side when the whole frame has passed.
+char RESP_FORMAT;			// Which frame format is passing: controller or servo.
+
+char MEASURING;				// Set while the child timeout timer is being used as a stopwatch.
+int MEASURE_TICKS;			// Stopwatch ticks since the child listener came up.
+int CHILD_PERIOD;			// A master-tuned child timeout period in ticks; zero means stock.
+
+char SERVO_FAULT;			// Set when servoFinder() could not resolve the servo.
+int RETRY_WAIT;				// Quiet passes since the last background servo retry.
+
+char BUS_TIER;				// The negotiated controller bus rate tier; zero is 57.6k baud.
+char TIER_ERRORS;			// Checksum failures in a row since the last clean frame.
+
+// These are the bus trace recorder.  While armed, the waiting parser timestamps every
+// frame it completes into this ring, so two traced modules side by side show exactly
+// where the per-hop milliseconds go without putting a scope on the pins.
+char TRACE_ARMED;			// Nonzero while the recorder is filing frames.
+int TRACE_CLOCK;			// Free-running millisecond clock, advanced by the tick ISR.
+int TRACE_MARK;				// The clock reading when the current frame started.
+int TRACE_STAMP[TRACE_SIZE];	// Recorded frame start times.
+char TRACE_TYPE[TRACE_SIZE];	// Recorded type bytes.
+char TRACE_SOURCE[TRACE_SIZE];	// Recorded source IDs.
+char TRACE_LEN[TRACE_SIZE];		// Recorded length bytes.
+char TRACE_HEAD;			// Where the next frame will be filed.
+char TRACE_COUNT;			// How many entries the ring currently holds.
+
+int TELEM_EPOCH;			// Milliseconds per reporting epoch; zero means no subscription.
+int TELEM_TICK;				// Where we are inside the current epoch, advanced by the tick ISR.
+int TELEM_SENT;				// Set once this epoch's report has gone out.
+
+void main()
+{	
+	int i;					// An index for zeroing the counter block.
+	
+	// Initial value assignment for variables of importance.
+	CHILD = 0;				// There is no child yet.
+	CONFIGURED = 0;			// This module is not configured yet.
+	TIMEOUT = 0;			// Set the timeout flag low to start.
+	COMMAND_PARAM = 0;		// There is no parameter yet.
+	STATE = 0;				// There is no state yet.
+	HELLO_PORT = 0;			// No start-bit edge has been seen yet.
+	ID = DEFAULT_ID;		// Set the ID of this controller to the default to start with.
+	RX_WRITE = 0;			// The receive ring buffer starts out empty.
+	RX_READ = 0;			// The read index starts where the write index starts.
+	PARSE_STATE = PARSE_IDLE;	// The parser starts out hunting for a start byte.
+	COMMAND_FORWARD = 0;		// No frame has been routed downstream yet.
+	TX_BUSY = 0;			// No transmission is in flight yet.
+	MODULE_STATUS = 0;		// Nothing bad has happened yet.
+	CMD_HEAD = 0;			// The command queue starts out empty.
+	CMD_TAIL = 0;
+	CMD_COUNT = 0;
+	FRAME_FORWARD = 0;		// No frame has been routed downstream yet.
+	IDLE_COUNT = 0;			// The main loop has not idled yet.
+	RESP_REPEAT = 0;		// The repeater starts out disarmed.
+	RESP_COUNT = 0;
+	RESP_EXPECT = 0;
+	RESP_DONE = 0;
+	RESP_FORMAT = 0;
+	MEASURING = 0;			// No measurement is in flight.
+	MEASURE_TICKS = 0;
+	CHILD_PERIOD = 0;		// The stock child timeout period applies until tuned.
+	SERVO_FAULT = 0;		// No servo fault has been declared yet.
+	RETRY_WAIT = 0;
+	BUS_TIER = 0;			// Every module wakes up at the rate everyone can hear.
+	TIER_ERRORS = 0;		// No checksum failures have happened yet.
+	TRACE_ARMED = 0;		// The trace recorder starts out disarmed.
+	TRACE_CLOCK = 0;
+	TRACE_MARK = 0;
+	TRACE_HEAD = 0;
+	TRACE_COUNT = 0;
+	TELEM_EPOCH = 0;		// No telemetry subscription is active.
+	TELEM_TICK = 0;
+	TELEM_SENT = 0;
+	
+	// Zero the performance counters.
+	for(i = 0; i < STAT_COUNT; i++)
+	{
+		STATS[i] = 0;
+	}
+
+	M8C_EnableGInt;			// Turn on global interrupts for the transmission timeout timer.
+	
+	M8C_EnableIntMask(INT_MSK0,INT_MSK0_GPIO); // Activate GPIO ISR
+	
+	// The response transmitters now live in the base configuration so that flipping the
+	// bus around for a response is a pin routing change instead of a configuration reload.
+	// Start them once here and leave them running forever.
+	TX_014_Start(TX_014_PARITY_NONE);	// Transmits on P00, P01, and P04.
+	TX_23_Start(TX_23_PARITY_NONE);		// Transmits on P02 and P03.
+	
+	// Turn on the transmit interrupt that drains the outgoing packet buffer.
+	TX_014_EnableInt();
+	
+	// Find the servo that is inside of this module.
+	servoFinder();
+	
+	// Loop and wait for commands.
+	while(1)
+	{	
+		if(commandReady())
+		{
+			// If the command is ready, take action.
+			takeAction();
+		}
+		
+		// If a telemetry subscription is active, report when our slot comes up.
+		telemetryPoll();
+		
+		// If the servo was never found, quietly keep trying to find it.
+		servoRecover();
+		
+		// If nothing at all is happening, stop burning the clock.
+		idleSleep();
+	}
+}
+
+// This function computes the checksum byte over a single-payload controller frame body
+// (source, destination, type, length, parameter).  It is the same complement-of-sum form the servos
+// already use, so both sides of the protocol check out the same way.
+char frameChecksum(char source, char dest, char type, char length, char param)
+{
+	return 255-((source + dest + type + length + param)%256);
+}
+
+// This function transmits a response to a hello command from the master.
+void sayHello(void)
+{	
+	char packet[10];					// The hello response frame.
+	char report;					// The child byte, with the servo fault folded in.
+	
+	// A module running without its servo still enumerates and relays; the fault flag
+	// rides the top of the child byte so the master knows this joint cannot move.
+	report = CHILD;
+	
+	if(SERVO_FAULT)
+	{
+		report |= HELLO_FAULT;
+	}
+	
+	// Build a hello response to the master node.
+	packet[0] = START_TRANSMIT;		// Start byte one
+	packet[1] = START_TRANSMIT;		// Start byte two
+	packet[2] = ID;					// My ID (source)
+	packet[3] = MASTER_ID;			// Master ID (destination)
+	packet[4] = HELLO_BYTE;			// This is a hello command.
+	packet[5] = 1;					// One payload byte follows.
+	packet[6] = report;				// Sends child port value, default 0.
+	packet[7] = frameChecksum(ID, MASTER_ID, HELLO_BYTE, 1, report);	// Frame checksum.
+	packet[8] = END_TRANSMIT;		// This is the end of this transmission.
+	packet[9] = END_TRANSMIT;		// This is the end of this transmission.
+	
+	busTransmit();					// Flip the bus around to talk.
+	
+	sendPacket(packet, 10);			// Hand the frame to the transmit interrupt.
+	
+	busReceive();					// Flip the bus back around to listen.
+}
+
+// These functions are the per-mode entry routines that the configuration dispatch table
+// points at.  Each one loads its configuration and starts whatever that mode needs.
+
+// Enters the wait receiver configuration.  This is the receiver configuration used after
+// initialization is complete.  It listens and forwards everything it hears.
+void enterWait(void)
+{
+	LoadConfig_waiting();
+
+	// Start the receivers.
+	WAIT_RECV_Start(WAIT_RECV_PARITY_NONE);
+	RX8_2_Start(RX8_2_PARITY_NONE);
+
+	// Turn on the receive interrupt so that bytes land in the ring buffer on arrival.
+	WAIT_RECV_EnableInt();
+
+	// Set the current state.
+	STATE = WAIT;
+}
+
+// Enters the response wait on port 1.
+void enterResponse1(void)
+{
+	LoadConfig_response1();
+
+	// Clear the timeout flag.
+	TIMEOUT = 0;
+
+	// Start listening for a response through child port 1.
+	CHILD_1_Start(CHILD_1_PARITY_NONE);
+
+	// Turn on the receive interrupt so that bytes land in the ring buffer on arrival.
+	CHILD_1_EnableInt();
+
+	CHILD_1_TIMEOUT_EnableInt();		// Make sure interrupts are enabled.
+	CHILD_1_TIMEOUT_Start();			// Start the timer.
+	
+	// The configuration load just put the stock period back, so swap in the stopwatch
+	// period for a measurement or re-apply the master-tuned one.
+	if(MEASURING)
+	{
+		CHILD_1_TIMEOUT_WritePeriod(MEASURE_PERIOD);
+	}
+	else if(CHILD_PERIOD)
+	{
+		CHILD_1_TIMEOUT_WritePeriod(CHILD_PERIOD);
+	}
+
+	// Set the current state.
+	STATE = RESPONSE_1;
+}
+
+// Enters the response wait on port 2.
+void enterResponse2(void)
+{
+	LoadConfig_response2();
+
+	// Clear the timeout flag.
+	TIMEOUT = 0;
+
+	// Start listening for a response through child port 2.
+	CHILD_2_Start(CHILD_2_PARITY_NONE);
+
+	// Turn on the receive interrupt so that bytes land in the ring buffer on arrival.
+	CHILD_2_EnableInt();
+
+	CHILD_2_TIMEOUT_EnableInt();		// Make sure interrupts are enabled.
+	CHILD_2_TIMEOUT_Start();			// Start the timer.
+	
+	// The configuration load just put the stock period back, so swap in the stopwatch
+	// period for a measurement or re-apply the master-tuned one.
+	if(MEASURING)
+	{
+		CHILD_2_TIMEOUT_WritePeriod(MEASURE_PERIOD);
+	}
+	else if(CHILD_PERIOD)
+	{
+		CHILD_2_TIMEOUT_WritePeriod(CHILD_PERIOD);
+	}
+
+	// Set the current state.
+	STATE = RESPONSE_2;
+}
+
+// Enters the response wait on port 3.
+void enterResponse3(void)
+{
+	LoadConfig_response3();
+
+	// Clear the timeout flag.
+	TIMEOUT = 0;
+
+	// Start listening for a response through child port 3.
+	CHILD_3_Start(CHILD_3_PARITY_NONE);
+
+	// Turn on the receive interrupt so that bytes land in the ring buffer on arrival.
+	CHILD_3_EnableInt();
+
+	CHILD_3_TIMEOUT_EnableInt();		// Make sure interrupts are enabled.
+	CHILD_3_TIMEOUT_Start();			// Start the timer.
+	
+	// The configuration load just put the stock period back, so swap in the stopwatch
+	// period for a measurement or re-apply the master-tuned one.
+	if(MEASURING)
+	{
+		CHILD_3_TIMEOUT_WritePeriod(MEASURE_PERIOD);
+	}
+	else if(CHILD_PERIOD)
+	{
+		CHILD_3_TIMEOUT_WritePeriod(CHILD_PERIOD);
+	}
+
+	// Set the current state.
+	STATE = RESPONSE_3;
+}
+
+// Enters the response wait on port 4.
+void enterResponse4(void)
+{
+	LoadConfig_response4();
+
+	// Clear the timeout flag.
+	TIMEOUT = 0;
+
+	// Start listening for a response through child port 4.
+	CHILD_4_Start(CHILD_4_PARITY_NONE);
+
+	// Turn on the receive interrupt so that bytes land in the ring buffer on arrival.
+	CHILD_4_EnableInt();
+
+	CHILD_4_TIMEOUT_EnableInt();		// Make sure interrupts are enabled.
+	CHILD_4_TIMEOUT_Start();			// Start the timer.
+	
+	// The configuration load just put the stock period back, so swap in the stopwatch
+	// period for a measurement or re-apply the master-tuned one.
+	if(MEASURING)
+	{
+		CHILD_4_TIMEOUT_WritePeriod(MEASURE_PERIOD);
+	}
+	else if(CHILD_PERIOD)
+	{
+		CHILD_4_TIMEOUT_WritePeriod(CHILD_PERIOD);
+	}
+
+	// Set the current state.
+	STATE = RESPONSE_4;
+}
+
+// Enters the hello wait mode.  This watches all four child ports at once.  The pins'
+// falling-edge GPIO interrupts do the start-bit detection, so no receiver user modules
+// have to be placed at all, and no port group alternation is needed on a device that can
+// only place two receivers at a time.
+void enterHelloAll(void)
+{
+	LoadConfig_hello1();
+
+	// Clear the timeout flag.
+	TIMEOUT = 0;
+
+	// No start-bit edge has been seen yet.
+	HELLO_PORT = 0;
+
+	HELLO_TIMEOUT_1_EnableInt();	// Make sure interrupts are enabled.
+	HELLO_TIMEOUT_1_Start();		// Start the timer.
+
+	// Set the current state.
+	STATE = HELLO_ALL;
+}
+
+// Enters the configuration for initialization.  This config listens but does not forward.
+void enterInitialize(void)
+{
+	LoadConfig_initial();
+
+	// Clear the timeout flag.
+	TIMEOUT = 0;
+
+	// Start the receiver.
+	INIT_RX_Start(INIT_RX_PARITY_NONE);
+
+	// Turn on the receive interrupt so that bytes land in the ring buffer on arrival.
+	INIT_RX_EnableInt();
+
+	INIT_TIMEOUT_EnableInt();	// Make sure interrupts are enabled.
+	INIT_TIMEOUT_Start();		// Start the timer.
+
+	// Set the current state.
+	STATE = INITIALIZE;
+}
+
+// Enters the configuration for servo communication.  This config only transmits on P00.
+void enterServoComm(void)
+{
+	LoadConfig_servo_transmit();
+
+	// Clear the timeout flag.
+	TIMEOUT = 0;
+
+	// Start the transmitter.
+	SERVO_TX_Start(SERVO_TX_PARITY_NONE);
+
+	// Set the current state.
+	STATE = SERVO_COMM;
+}
+
+// This table maps a configuration mode identifier straight to its entry routine.  The
+// mode identifiers are a dense set, so dispatch is one indexed call instead of a
+// comparison ladder that gets longer (and slower on the hot path) with every mode.
+// The empty slots belong to identifiers that no longer name a loadable configuration.
+const actionFunc CONFIG_ENTER[] = {
+	0,					// 0 is not a valid mode.
+	enterWait,			// WAIT
+	0,					// Old MY_RESPONSE slot; the transmitters are resident now.
+	enterResponse1,		// RESPONSE_1
+	enterResponse2,		// RESPONSE_2
+	enterResponse3,		// RESPONSE_3
+	enterResponse4,		// RESPONSE_4
+	enterHelloAll,		// HELLO_ALL
+	0,					// Old HELLO_MODE_2 slot; one hello config covers all ports now.
+	enterInitialize,	// INITIALIZE
+	enterServoComm		// SERVO_COMM
+};
+
+// This table maps a configuration mode identifier straight to its unload routine.
+const actionFunc CONFIG_UNLOAD[] = {
+	0,						// 0 is not a valid mode.
+	UnloadConfig_waiting,	// WAIT
+	0,						// Old MY_RESPONSE slot.
+	UnloadConfig_response1,	// RESPONSE_1
+	UnloadConfig_response2,	// RESPONSE_2
+	UnloadConfig_response3,	// RESPONSE_3
+	UnloadConfig_response4,	// RESPONSE_4
+	UnloadConfig_hello1,	// HELLO_ALL
+	0,						// Old HELLO_MODE_2 slot.
+	UnloadConfig_initial,	// INITIALIZE
+	UnloadConfig_servo_transmit	// SERVO_COMM
+};
+
+// This function receives a mode flag and switches the microcontroller to the
+// desired hardware configuration.
+void configToggle(int mode)
+{
+	// Set the pins high and disconnect from the global bus.
+	// This keeps false start bits from happening while we swap configs.
+	PRT0DR |= 0b00011111;	// Set pins P00 through P04 high.
+	PRT0GS &= 0b11100000;	// Disconnect pins P00 through P04 from the global bus.
+
+	// Throw away anything left over from the old configuration's receiver and put the
+	// parser back at the start.  A half-parsed frame from one mode means nothing in another.
+	rxFlush();
+
+	// Count the toggle.  Configuration reloads are the single biggest time sink on the
+	// chain, so this counter is the first thing to look at when a rig slows down.
+	statBump(STAT_TOGGLES);
+	
+	// Unload the configuration of the current state.
+	// If there is no state, blindly wipe all configurations.
+	if(STATE)
+	{
+		unloadConfig(STATE);
+	}
+	else
+	{
+		unloadAllConfigs();
+	}
+
+	// Look up the entry routine for the requested mode and run it.
+	if(CONFIG_ENTER[mode])
+	{
+		CONFIG_ENTER[mode]();
+	}
+
+	// The servo leg keeps its own fixed rate, so the dividers follow whichever side of
+	// the module the new configuration talks to.
+	if((STATE == SERVO_COMM) || (STATE == INITIALIZE))
+	{
+		applyBaudTier(0);
+	}
+	else
+	{
+		applyBaudTier(BUS_TIER);
+	}
+
+	// If this module is configured, talk on all pins for potential children.
+	if(CONFIGURED)
+	{
+		PRT0GS |= 0b00011111;	// Connect all pins to the global bus.
+		PRT2DR &= 0b11111110;	// Turn on the LED (active low).
+	}
+	else
+	{
+		PRT0GS |= 0b00000001;	// Just connect pin 0;
+		PRT2DR |= 0b00000001;	// Turn off the LED (active low).
+	}
+}
+
+// This function flips the half-duplex bus pins from receive to transmit.  The response
+// transmitters have been loaded and running since boot, so all that moves here is the pin
+// routing -- the direction switch costs a couple of register writes instead of the old
+// MY_RESPONSE configuration reload.
+void busTransmit(void)
+{
+	// If some listening configuration other than the resident wait receiver is loaded,
+	// drop back to it first.  This only happens off the hot relay path (hello listening
+	// and child responses); on a normal response no reload happens at all.
+	if(STATE != WAIT)
+	{
+		configToggle(WAIT);
+	}
+	
+	// Wait for the listener on the other end to say its configuration is loaded.  The
+	// receiver that is about to catch this frame fires READY_BYTE the instant its config
+	// is up, so this wait ends the moment the peer can actually hear us.  The timer still
+	// runs underneath as a fallback: if the sentinel is lost (or the listener never sends
+	// one, like the master), we degrade to the old fixed 1 ms wait instead of hanging.
+	TIMEOUT = 0;
+	TX_01234_TIMEOUT_EnableInt();		// Make sure interrupts are enabled.
+	TX_01234_TIMEOUT_Start();			// Start the timer.
+	
+	while(!TIMEOUT)
+	{
+		if(rxBytesReady())
+		{
+			if(rxGetByte() == READY_BYTE)
+			{
+				break;
+			}
+		}
+	}
+	
+	TX_01234_TIMEOUT_Stop();			// Stop the timer.
+	TIMEOUT = 0;						// Reset the timeout flag.
+	
+	// Park the pins high and hand them to the transmitters.  Parking them high first
+	// keeps anyone listening from seeing a false start bit during the switch.
+	PRT0DR |= 0b00011111;	// Set pins P00 through P04 high.
+	PRT0GS &= 0b11100000;	// Take the pins away from the receive routing.
+	PRT0DM0 |= 0b00011111;	// Drive the pins from the transmitter outputs.
+	
+	// If this module is configured, talk on all pins for potential children.
+	if(CONFIGURED)
+	{
+		PRT0GS |= 0b00011111;	// Connect all pins to the global bus.
+	}
+	else
+	{
+		PRT0GS |= 0b00000001;	// Just connect pin 0.
+	}
+}
+
+// This function flips the half-duplex bus pins from transmit back to receive.  It waits
+// for the last byte to completely clear the wire first, since turning the pins around
+// mid-byte would chop the transmission.
+void busReceive(void)
+{
+	// Wait for the transmit interrupt to finish draining the outgoing frame.  The
+	// interrupt fires on transmit complete, so when the flag drops the last byte has
+	// already cleared the shifter.
+	while(TX_BUSY) { }
+	
+	// Make completely sure we're done.
+	xmitWait();
+	
+	// Stop driving the pins and give them back to the receive routing.
+	PRT0DM0 &= 0b11100000;	// Release the pins.
+	PRT0GS &= 0b11100000;	// Take the pins away from the transmit routing.
+	
+	// Throw away whatever our own transmission left behind.
+	rxFlush();
+	
+	// If this module is configured, listen on all pins for potential children.
+	if(CONFIGURED)
+	{
+		PRT0GS |= 0b00011111;	// Connect all pins to the global bus.
+	}
+	else
+	{
+		PRT0GS |= 0b00000001;	// Just connect pin 0.
+	}
+}
+
+// This function fires the single config-ready sentinel byte at a child that is about to
+// respond.  It is called right after a response configuration finishes loading, so the
+// child's busTransmit() can stop waiting the moment we can actually hear it.  The pin
+// flip is the same register dance as busTransmit()/busReceive(), minus the configuration
+// reload checks -- the caller has just loaded the posture it wants to be in.
+void signalReady(void)
+{
+	char ready = READY_BYTE;	// The sentinel itself.
+	
+	// Park the pins high and hand them to the transmitters.
+	PRT0DR |= 0b00011111;	// Set pins P00 through P04 high.
+	PRT0GS &= 0b11100000;	// Take the pins away from the receive routing.
+	PRT0DM0 |= 0b00011111;	// Drive the pins from the transmitter outputs.
+	PRT0GS |= 0b00011111;	// Connect all pins to the global bus.
+	
+	// Fire the sentinel.
+	sendPacket(&ready, 1);
+	
+	// Wait for it to completely clear the wire.
+	while(TX_BUSY) { }
+	
+	// Make completely sure we're done.
+	xmitWait();
+	
+	// Stop driving the pins and give them back to the receive routing.
+	PRT0DM0 &= 0b11100000;	// Release the pins.
+	PRT0GS &= 0b11100000;	// Take the pins away from the transmit routing.
+	
+	// Throw away whatever our own transmission left behind.
+	rxFlush();
+	
+	// Reconnect and get back to listening for the response.
+	PRT0GS |= 0b00011111;	// Connect all pins to the global bus.
+}
+
+// This function hands a prebuilt frame to the transmit hardware.  The frame is copied
+// into the outgoing buffer, the first byte is dropped into both transmitters, and the
+// transmit-complete interrupt feeds the rest byte by byte.  The function returns as soon
+// as the transfer is set up, so the CPU is free to go back to parsing received bytes
+// while the frame drains -- busReceive() is what finally waits for completion before
+// turning the bus around.
+void sendPacket(char *packet, int length)
+{
+	int i = 0;		// An index variable for the copy loop.
+	
+	// If a frame is somehow still in flight, let it drain first.
+	while(TX_BUSY) { }
+	
+	// Copy the frame into the buffer that the transmit interrupt owns.
+	for(i = 0; i < length; i++)
+	{
+		TX_BUFFER[i] = packet[i];
+	}
+	
+	TX_INDEX = 0;		// The first byte is about to be in the hardware.
+	TX_LENGTH = length;	// Remember how much there is to send.
+	TX_BUSY = 1;		// Mark the transmitter as owned until the frame drains.
+	
+	// Prime both transmitters with the first byte.  Every byte after this one is fed
+	// from the transmit-complete interrupt.
+	TX_014_SendData(TX_BUFFER[0]);
+	TX_23_SendData(TX_BUFFER[0]);
+}
+
+// This function checks whether a complete command has arrived.  The receive interrupts
+// deposit every byte into the ring buffer as it comes off the wire, so this function never
+// blocks; it drains whatever has been buffered through the packet parser state machine and
+// returns 1 the moment a full command has been assembled, or 0 if the buffer runs dry with
+// a frame still in flight.  The parser remembers its place between calls, so a frame that
+// arrives mid-parse is picked up cleanly instead of being lost.
+int commandReady(void)
+{
+	int i;					// An index for copying the payload.
+	
+	// The hello configuration has no receivers at all.  The GPIO interrupt records which
+	// child port saw a start-bit edge; all we do here is report that record.  Turning
+	// the edge into a registered child is childListen()'s job, and it demands a whole
+	// valid hello frame first.
+	if(STATE == HELLO_ALL)
+	{
+		return (HELLO_PORT != 0);
+	}
+	
+	// Every other configuration is interrupt fed.  Run the buffered bytes through the
+	// parser until the bytes run out or the command queue fills.  When the queue is
+	// full, unparsed bytes simply wait in the ring buffer -- nothing is dropped.
+	while(rxBytesReady() && (CMD_COUNT < CMD_QUEUE_SIZE))
+	{
+		parseByte(rxGetByte());
+	}
+	
+	// Hand the oldest queued command to the caller.
+	if(CMD_COUNT)
+	{
+		COMMAND_SOURCE = CMD_SOURCE[CMD_TAIL];
+		COMMAND_DESTINATION = CMD_DEST[CMD_TAIL];
+		COMMAND_TYPE = CMD_TYPE[CMD_TAIL];
+		COMMAND_PARAM = CMD_PARAM[CMD_TAIL];
+		COMMAND_LENGTH = CMD_LENGTH[CMD_TAIL];
+		COMMAND_ERROR = CMD_ERROR[CMD_TAIL];
+		COMMAND_FORWARD = CMD_FORWARD[CMD_TAIL];
+		
+		for(i = 0; (i < COMMAND_LENGTH) && (i < PAYLOAD_MAX); i++)
+		{
+			COMMAND_PAYLOAD[i] = CMD_PAYLOAD[CMD_TAIL][i];
+		}
+		
+		CMD_TAIL = (CMD_TAIL + 1)%CMD_QUEUE_SIZE;
+		CMD_COUNT--;
+		
+		return 1;
+	}
+	
+	return 0;
+}
+
+// This function checks a frame's length byte against the shared protocol table.  Known
+// commands must carry exactly the payload the table says; a zero table entry marks a
+// variable-length command, and codes outside the command block (servo relays, future
+// masters) pass unchecked.
+int lengthOk(char type, char length)
+{
+	if((type >= COMMAND_BASE) && (type < (COMMAND_BASE + COMMAND_COUNT)))
+	{
+		if(COMMAND_LENGTHS[type - COMMAND_BASE])
+		{
+			return (length == COMMAND_LENGTHS[type - COMMAND_BASE]);
+		}
+	}
+	
+	return 1;
+}
+
+// This function files the frame the parser just finished into the command queue and
+// reports the completion.  With two slots, a second command can arrive in full while a
+// handler is still busy with the first -- the multi-second servo re-ID loop, say --
+// instead of being lost and costing the master a timeout and a retry.
+int framePush(void)
+{
+	int i;					// An index for copying the payload.
+	
+	// If both slots are somehow full, the newest frame is the one that loses, which is
+	// no worse than the single-buffer behavior this replaced.
+	if(CMD_COUNT < CMD_QUEUE_SIZE)
+	{
+		CMD_SOURCE[CMD_HEAD] = FRAME_SOURCE;
+		CMD_DEST[CMD_HEAD] = FRAME_DEST;
+		CMD_TYPE[CMD_HEAD] = FRAME_TYPE;
+		CMD_PARAM[CMD_HEAD] = FRAME_PARAM;
+		CMD_LENGTH[CMD_HEAD] = FRAME_LENGTH;
+		CMD_ERROR[CMD_HEAD] = FRAME_ERROR;
+		CMD_FORWARD[CMD_HEAD] = FRAME_FORWARD;
+		
+		// The length field is shared with servo frames, whose lengths can run past the
+		// payload buffer, so the copy is clamped to what the buffer actually holds.
+		for(i = 0; (i < FRAME_LENGTH) && (i < PAYLOAD_MAX); i++)
+		{
+			CMD_PAYLOAD[CMD_HEAD][i] = FRAME_PAYLOAD[i];
+		}
+		
+		CMD_HEAD = (CMD_HEAD + 1)%CMD_QUEUE_SIZE;
+		CMD_COUNT++;
+	}
+	
+	// The routing flag has been handed off with the frame it belongs to.
+	FRAME_FORWARD = 0;
+	
+	// A clean frame proves the link still works at the current rate.
+	TIER_ERRORS = 0;
+	
+	return 1;
+}
+
+// This function returns 1 if the receive ring buffer holds at least one unread byte.
+int rxBytesReady(void)
+{
+	return (RX_READ != RX_WRITE);
+}
+
+// This function pulls the oldest unread byte out of the receive ring buffer.  It should
+// only be called after rxBytesReady() has confirmed that there is something to read.
+char rxGetByte(void)
+{
+	char newByte;
+	
+	newByte = RX_BUFFER[RX_READ];				// Grab the oldest byte.
+	RX_READ = (RX_READ + 1) & RX_BUFFER_MASK;	// Advance the read index with wrap-around.
+	
+	return newByte;
+}
+
+// This function throws away everything in the receive ring buffer and resets the parser.
+// This is done on every configuration change, since a half-parsed frame from one
+// configuration means nothing in another.  Fully parsed commands are a different story:
+// anything already in the command queue passed its checks as a whole frame, so it
+// survives the flush and waits its turn -- the queue exists precisely so a frame that
+// arrives while a handler is busy toggling configurations is not lost.
+void rxFlush(void)
+{
+	RX_READ = RX_WRITE;			// Catch the read index up to the write index.
+	PARSE_STATE = PARSE_IDLE;	// Put the parser back at the start.
+	PARSE_COUNT = 0;			// No pass-through bytes are pending.
+	FRAME_FORWARD = 0;			// Any routing decision died with the half-parsed frame.
+}
+
+// This function runs a single byte through the packet parser state machine.  The set of
+// states the parser moves through depends on which configuration is loaded, since the wait
+// receiver, the initialization receiver, and the child response receivers all see different
+// frame layouts.  Returns 1 if this byte completed a command, 0 otherwise.
+int parseByte(char newByte)
+{
+	if(STATE == WAIT)
+	{
+		if(PARSE_STATE == PARSE_IDLE)
+		{
+			// If the trace recorder is armed, this byte is a frame start worth stamping.
+			if(TRACE_ARMED)
+			{
+				TRACE_MARK = TRACE_CLOCK;
+			}
+			
+			if(newByte == START_TRANSMIT)
+			{
+				// A controller transmission has started.  The next non-start byte is the source.
+				PARSE_STATE = PARSE_SOURCE;
+			}
+			else if(newByte == SERVO_START)
+			{
+				// A servo transmission has started.  The next non-start byte is the destination.
+				PARSE_STATE = PARSE_SERVO_DEST;
+			}
+		}
+		else if(PARSE_STATE == PARSE_SOURCE)
+		{
+			// Repeated start bytes are skipped while we sit in this state.
+			if(newByte != START_TRANSMIT)
+			{
+				if(newByte == MASTER_ID)
+				{
+					// The source is good, so store it and collect the rest of the frame.
+					FRAME_SOURCE = newByte;
+					PARSE_SUM = newByte;
+					PARSE_STATE = PARSE_DESTINATION;
+				}
+				else
+				{
+					// Anyone other than the master has no business talking to us here.
+					PARSE_STATE = PARSE_IDLE;
+					
+					statBump(STAT_BAD_FRAMES);
+				}
+			}
+		}
+		else if(PARSE_STATE == PARSE_DESTINATION)
+		{
+			FRAME_DEST = newByte;
+			PARSE_SUM += newByte;
+			
+			// Route on the destination byte, before the rest of the frame arrives.  A
+			// frame addressed deeper in the chain needs nothing from this module except
+			// a return path for the response, so the pass-through route is closed right
+			// now, while the remaining bytes are still in flight.  The route stacks on
+			// top of the waiting configuration, so the frame keeps flowing downstream
+			// underneath it and nothing gets cut off.
+			if(CONFIGURED && CHILD && (newByte != BROADCAST) && (newByte > ID))
+			{
+				LoadConfig_pass_through();
+				FRAME_FORWARD = 1;
+			}
+			
+			PARSE_STATE = PARSE_TYPE;
+		}
+		else if(PARSE_STATE == PARSE_TYPE)
+		{
+			FRAME_TYPE = newByte;
+			PARSE_SUM += newByte;
+			PARSE_STATE = PARSE_LENGTH;
+		}
+		else if(PARSE_STATE == PARSE_LENGTH)
+		{
+			FRAME_LENGTH = newByte;
+			PARSE_SUM += newByte;
+			
+			if((newByte > 0) && (newByte <= PAYLOAD_MAX) && lengthOk(FRAME_TYPE, newByte))
+			{
+				// Count the payload bytes off as they arrive.
+				PARSE_COUNT = 0;
+				PARSE_STATE = PARSE_PAYLOAD;
+			}
+			else
+			{
+				// No sender of ours produces an empty or oversized payload, and the
+				// protocol table says what every known command carries, so this
+				// length is corruption and the frame is dropped like any other.
+				PARSE_STATE = PARSE_IDLE;
+				
+				statBump(STAT_BAD_FRAMES);
+				tierError();
+				
+				// If the destination byte already opened the pass-through route, close
+				// it again.
+				if(FRAME_FORWARD)
+				{
+					UnloadConfig_pass_through();
+					FRAME_FORWARD = 0;
+				}
+			}
+		}
+		else if(PARSE_STATE == PARSE_PAYLOAD)
+		{
+			FRAME_PAYLOAD[PARSE_COUNT] = newByte;
+			PARSE_SUM += newByte;
+			
+			// The first payload byte doubles as the classic single parameter, so every
+			// one-parameter command reads exactly the way it always has.
+			if(PARSE_COUNT == 0)
+			{
+				FRAME_PARAM = newByte;
+			}
+			
+			PARSE_COUNT++;
+			
+			if(PARSE_COUNT >= FRAME_LENGTH)
+			{
+				PARSE_STATE = PARSE_CHECKSUM;
+			}
+		}
+		else if(PARSE_STATE == PARSE_CHECKSUM)
+		{
+			// The frame only counts once its checksum checks out.  On a mismatch the
+			// frame is dropped right here -- corrupted traffic costs one byte-time
+			// instead of a mis-routed command and a timeout recovery cycle later.
+			PARSE_STATE = PARSE_IDLE;
+			
+			if(newByte == (255-(PARSE_SUM%256)))
+			{
+				traceFrame();
+				
+				return framePush();
+			}
+			
+			// The frame was corrupt.
+			statBump(STAT_BAD_FRAMES);
+			tierError();
+			
+			// If the destination byte already opened the pass-through route, close it
+			// again -- everyone deeper saw the same corruption, so no response is coming.
+			if(FRAME_FORWARD)
+			{
+				UnloadConfig_pass_through();
+				FRAME_FORWARD = 0;
+			}
+		}
+		else if(PARSE_STATE == PARSE_SERVO_DEST)
+		{
+			// Repeated start bytes are skipped while we sit in this state.
+			if(newByte != SERVO_START)
+			{
+				// We assume (and hopefully rightly so) that this is a command from master.
+				FRAME_SOURCE = MASTER_ID;
+				// The first parameter after the servo start is the destination.
+				FRAME_DEST = newByte;
+				
+				// Servo frames route on the destination byte too, under the same rule
+				// as controller frames above.
+				if(CONFIGURED && CHILD && (newByte != BROADCAST) && (newByte > ID))
+				{
+					LoadConfig_pass_through();
+					FRAME_FORWARD = 1;
+				}
+				
+				PARSE_STATE = PARSE_SERVO_LENGTH;
+			}
+		}
+		else if(PARSE_STATE == PARSE_SERVO_LENGTH)
+		{
+			// We don't need the length to wait for the transmission to go through since the
+			// transmission goes through the chip with a delay of approximately 100 ns
+			// (it is already in and out by the time you read this byte).  We just use it
+			// to count off the bytes that remain after the instruction.
+			FRAME_LENGTH = newByte;
+			PARSE_COUNT = newByte - 1;
+			PARSE_STATE = PARSE_SERVO_TYPE;
+		}
+		else if(PARSE_STATE == PARSE_SERVO_TYPE)
+		{
+			// Now we store the command type.  Depending on what the status return level
+			// is, we have special duties.
+			FRAME_TYPE = newByte;
+			
+			if(PARSE_COUNT > 0)
+			{
+				// The rest of the command still has to pass through.
+				PARSE_STATE = PARSE_SERVO_BURN;
+			}
+			else
+			{
+				PARSE_STATE = PARSE_IDLE;
+				
+				traceFrame();
+				
+				return framePush();
+			}
+		}
+		else if(PARSE_STATE == PARSE_SERVO_BURN)
+		{
+			// This basically waits for the rest of the command to pass through.
+			PARSE_COUNT--;
+			
+			if(PARSE_COUNT <= 0)
+			{
+				PARSE_STATE = PARSE_IDLE;
+				
+				traceFrame();
+				
+				return framePush();
+			}
+		}
+	}
+	else if(STATE == INITIALIZE)
+	{
+		if(PARSE_STATE == PARSE_IDLE)
+		{
+			if(newByte == SERVO_START)
+			{
+				PARSE_STATE = PARSE_INIT_START;
+			}
+		}
+		else if(PARSE_STATE == PARSE_INIT_START)
+		{
+			// We officially have a transmission once we see the second start byte.
+			if(newByte == SERVO_START)
+			{
+				PARSE_STATE = PARSE_INIT_SOURCE;
+			}
+			else
+			{
+				PARSE_STATE = PARSE_IDLE;
+			}
+		}
+		else if(PARSE_STATE == PARSE_INIT_SOURCE)
+		{
+			FRAME_SOURCE = newByte;
+			PARSE_STATE = PARSE_INIT_LENGTH;
+		}
+		else if(PARSE_STATE == PARSE_INIT_LENGTH)
+		{
+			FRAME_LENGTH = newByte;
+			PARSE_STATE = PARSE_INIT_ERROR;
+		}
+		else if(PARSE_STATE == PARSE_INIT_ERROR)
+		{
+			FRAME_ERROR = newByte;
+			PARSE_STATE = PARSE_INIT_PARAM;
+		}
+		else if(PARSE_STATE == PARSE_INIT_PARAM)
+		{
+			FRAME_PARAM = newByte;
+			PARSE_STATE = PARSE_IDLE;
+			
+			return framePush();
+		}
+	}
+	else if((STATE == RESPONSE_1) || (STATE == RESPONSE_2) ||
+			(STATE == RESPONSE_3) || (STATE == RESPONSE_4))
+	{
+		// All four child response receivers see the same frame layouts, and only one of
+		// them is ever loaded at a time, so they share one set of parser states.
+		if(PARSE_STATE == PARSE_IDLE)
+		{
+			if(newByte == SERVO_START)				// We have a servo response coming.
+			{
+				PARSE_STATE = PARSE_RESP_SERVO_SKIP;
+			}
+			else if(newByte == START_TRANSMIT)		// We have a controller response coming.
+			{
+				PARSE_STATE = PARSE_RESP_CTRL_SOURCE;
+			}
+		}
+		else if(PARSE_STATE == PARSE_RESP_CTRL_SOURCE)
+		{
+			// Repeated start bytes are skipped while we sit in this state.  Child
+			// responses carry the same body layout as master commands, and the fields
+			// are captured here so that callers can see who answered and with what.
+			if(newByte != START_TRANSMIT)
+			{
+				FRAME_SOURCE = newByte;
+				PARSE_SUM = newByte;
+				PARSE_STATE = PARSE_RESP_CTRL_DEST;
+			}
+		}
+		else if(PARSE_STATE == PARSE_RESP_CTRL_DEST)
+		{
+			FRAME_DEST = newByte;
+			PARSE_SUM += newByte;
+			PARSE_STATE = PARSE_RESP_CTRL_TYPE;
+		}
+		else if(PARSE_STATE == PARSE_RESP_CTRL_TYPE)
+		{
+			FRAME_TYPE = newByte;
+			PARSE_SUM += newByte;
+			PARSE_STATE = PARSE_RESP_CTRL_LENGTH;
+		}
+		else if(PARSE_STATE == PARSE_RESP_CTRL_LENGTH)
+		{
+			FRAME_LENGTH = newByte;
+			PARSE_SUM += newByte;
+			
+			if((newByte > 0) && (newByte <= PAYLOAD_MAX) && lengthOk(FRAME_TYPE, newByte))
+			{
+				PARSE_COUNT = 0;
+				PARSE_STATE = PARSE_RESP_CTRL_PAYLOAD;
+			}
+			else
+			{
+				// A response with an impossible length is corruption.
+				PARSE_STATE = PARSE_IDLE;
+				
+				statBump(STAT_BAD_FRAMES);
+				tierError();
+			}
+		}
+		else if(PARSE_STATE == PARSE_RESP_CTRL_PAYLOAD)
+		{
+			FRAME_PAYLOAD[PARSE_COUNT] = newByte;
+			PARSE_SUM += newByte;
+			
+			if(PARSE_COUNT == 0)
+			{
+				FRAME_PARAM = newByte;
+			}
+			
+			PARSE_COUNT++;
+			
+			if(PARSE_COUNT >= FRAME_LENGTH)
+			{
+				PARSE_STATE = PARSE_RESP_CTRL_CHECK;
+			}
+		}
+		else if(PARSE_STATE == PARSE_RESP_CTRL_CHECK)
+		{
+			if(newByte == (255-(PARSE_SUM%256)))
+			{
+				// The body is good; all that is left is the end of the frame.
+				PARSE_STATE = PARSE_RESP_CTRL_END;
+			}
+			else
+			{
+				// A corrupt response is dropped just like a corrupt command.
+				PARSE_STATE = PARSE_IDLE;
+				
+				statBump(STAT_BAD_FRAMES);
+				tierError();
+			}
+		}
+		else if(PARSE_STATE == PARSE_RESP_SERVO_SKIP)
+		{
+			// Burn through the rest of the start bytes and the servo ID.
+			if(newByte != SERVO_START)
+			{
+				PARSE_STATE = PARSE_RESP_SERVO_LENGTH;
+			}
+		}
+		else if(PARSE_STATE == PARSE_RESP_SERVO_LENGTH)
+		{
+			// We store the length, since it counts off the rest of the frame for us.
+			PARSE_COUNT = newByte;
+			
+			if(PARSE_COUNT > 0)
+			{
+				PARSE_STATE = PARSE_RESP_SERVO_BURN;
+			}
+			else
+			{
+				PARSE_STATE = PARSE_IDLE;
+				
+				return framePush();
+			}
+		}
+		else if(PARSE_STATE == PARSE_RESP_SERVO_BURN)
+		{
+			// This basically waits for the rest of the command to pass through.
+			PARSE_COUNT--;
+			
+			if(PARSE_COUNT <= 0)
+			{
+				PARSE_STATE = PARSE_IDLE;
+				
+				return framePush();
+			}
+		}
+		else if(PARSE_STATE == PARSE_RESP_CTRL_END)
+		{
+			// We simply wait for the end transmit indicator.
+			if(newByte == END_TRANSMIT)
+			{
+				PARSE_STATE = PARSE_IDLE;
+				
+				return framePush();
+			}
+		}
+	}
+	
+	return 0;
+}
+
+// These functions are the per-command handlers that the command dispatch table points
+// at.  Each one is the body that used to live in a branch of takeAction()'s ladder.
+
+// The master is probing for new modules.
+void helloAction(void)
+{
+	if(!CONFIGURED)
+	{
+		// Announce this module's presence if not configured.
+		sayHello();
+	}
+	else if(!CHILD)
+	{
+		// Listen for children if we have none.
+		if(childListen())
+		{
+			// If a child was heard saying hello, forward the command with the port number added.
+			sayHello();
+			
+			// A child is now part of this module's identity, so refresh the cache.
+			// The flash write parks the CPU for milliseconds, so it goes out after
+			// the hello the master is waiting on, never ahead of it.
+			cacheStore();
+		}
+	}
+	else if(CHILD)
+	{
+		// If you have a child established, listen to that child.
+		childResponse();
+	}
+}
+
+// The master is trying to find a module that is configured.
+void pingAction(void)
+{
+	// If this is to me, act accordingly.
+	if(COMMAND_DESTINATION == ID)
+	{
+		// Ping back to the master.
+		pingResponse();
+	}
+	else if(COMMAND_DESTINATION > ID)
+	{
+		// If you have a child established, listen to that child.
+		childResponse();
+	}
+}
+
+// The master is assigning an ID to someone.
+void idAssignAction(void)
+{
+	// If this is meant for me, change my ID.
+	if(COMMAND_DESTINATION == ID)
+	{
+		if((COMMAND_PARAM > MASTER_ID) && (COMMAND_PARAM < DEFAULT_ID))
+		{
+			// Assign this module the ID that has been passed by the master.
+			ID = COMMAND_PARAM;
+
+			// This module is now configured.
+			CONFIGURED = 1;
+
+			// SERVO_ID survives a CLEAR_CONFIG in RAM and a power cycle in the
+			// identity cache, so a reconfiguration that lands on the same number
+			// skips the servo traffic below entirely.
+
+			// If the servo ID doesn't match what we want, change it to match.  The
+			// servo's current ID is already known from servoFinder(), so the happy
+			// path is one targeted write and one targeted verify ping.  The broadcast
+			// retry storm below it -- up to twenty pings, each with two configuration
+			// swaps -- is kept only for a servo that did not take the write.  A
+			// faulted servo is skipped outright: there is nothing to write to, and
+			// burning the storm on it would stall the master's whole sweep.
+			if((ID != SERVO_ID) && (!SERVO_FAULT))
+			{
+				// These are our index variables for communication attempt timeouts.
+				int i;
+				int j;
+
+				// Send one write at the servo's known ID to change it, then ping the
+				// new ID directly to confirm the change took.
+				servoWrite(SERVO_ID, ID_ADDRESS, ID);
+				servoInstruction(ID, PING_LENGTH, PING_SERVO, 0, 0);
+
+				while(!TIMEOUT)
+				{
+					if(commandReady())
+					{
+						if((!COMMAND_ERROR) && (COMMAND_SOURCE == ID))
+						{
+							// The servo took the write on the first try.
+							SERVO_ID = ID;
+							
+							// Set the timeout flag to exit the while loop.
+							TIMEOUT = 1;
+						}
+					}
+				}
+
+				// Only a failed verify is worth falling back to the retry storm.
+				for(j = 0; (j < SERVO_COMM_LOOPS) && (ID != SERVO_ID); j++)
+				{
+					// Send a request to change the servo ID to match the controller ID.
+					// The write produces no response, so there is nothing to listen for.
+					servoWrite(SERVO_ID, ID_ADDRESS, ID);
+
+					// Try to read the servo's ID several times.
+					for(i = 0; i < SERVO_COMM_ATTEMPTS; i++)
+					{
+						// Send a request for the servo ID, which is presumably now equal to ID.
+						servoInstruction(BROADCAST, PING_LENGTH, PING_SERVO, 0, 0);
+
+						// Wait for either a timeout or an indication that we want to exit the loop.
+						while(!TIMEOUT)
+						{
+							// If we have a command to interpret, read it.
+							if(commandReady())
+							{
+								if(!COMMAND_ERROR)
+								{
+									// If we have a valid servo ID, exit the loop.
+									if(COMMAND_SOURCE == ID)
+									{
+										// Set the timeout flag to exit the while loop.
+										TIMEOUT = 1;
+										// Set i such that the for loop is exited.
+										i = SERVO_COMM_ATTEMPTS;
+										// Set j such that we exit the outer loop as well.
+										j = SERVO_COMM_LOOPS;
+										// Store the ID value.
+										SERVO_ID = ID;
+									}
+								}
+							}
+						}
+					}
+				}
+			}
+
+			if((ID != SERVO_ID) && (!SERVO_FAULT))
+			{
+				// Toggle back to normal wait mode.
+				configToggle(WAIT);
+			}
+			else
+			{
+				// Let the master node know that you got the ID assignment.  A
+				// faulted module acks too: it still relays and enumerates, the
+				// master hears about the dead joint through the hello byte and the
+				// acks, and the background retry re-adopts the servo if it comes
+				// back.
+				assignedID();
+
+				// Remember this identity across power cycles.
+				cacheStore();
+
+				// Now probe for our own child right away instead of sitting idle
+				// until the master's next hello sweep.  The master is assigning
+				// IDs upstream while this runs, so the two overlap.
+				childProbe();
+			}
+		}
+	}
+	else if(COMMAND_DESTINATION > ID)
+	{
+		// Switch to listen to your child.
+		childResponse();
+	}
+}
+
+// The master wants to clear one or all configurations.
+void clearConfigAction(void)
+{
+	// Only respond if this is directly to me and not a mass config clear.
+	if(COMMAND_DESTINATION == ID)
+	{
+		configCleared();	// Notify the master that I am clearing my config.
+	}
+
+	// If this is meant for me, deconfigure.  Also, if a module ahead of you is
+	// getting deconfigured, you have no choice but to deconfigure as well to
+	// avoid errors on reconfiguration.
+	if((COMMAND_DESTINATION <= ID) || (COMMAND_DESTINATION == BROADCAST))
+	{
+		ID = DEFAULT_ID;	// Reset my ID to the default.
+		CONFIGURED = 0;		// I am no longer configured.
+		CHILD = 0;			// No one can depend on you anymore.
+		
+		// A deliberate deconfiguration makes the cached identity a lie, so kill it.
+		cacheClear();
+	}
+
+	// Turn off the LED.
+	PRT2DR |= 0b00000001;
+}
+
+// A servo command is passing along the chain.
+void servoRelayAction(void)
+{
+	if(COMMAND_DESTINATION > ID)
+	{
+		// Allow the child response through.
+		childResponse();
+	}
+	else if(COMMAND_DESTINATION <= ID)
+	{
+		// The response is for someone behind us.  Close the hardware pass-through
+		// route and let the whole exchange fly by at the row interconnect.
+		passThrough();
+	}
+}
+
+// The master is streaming a batched sync-move frame through the chain.  One frame
+// carries an (ID, position, speed) tuple for every module; the parameter byte is the
+// tuple count.  We close the hardware pass-through route so the tuples cut straight
+// through to the next module as they arrive -- no store-and-forward -- and all the CPU
+// does is snoop the stream and peel off the tuple addressed to this module's servo.
+void syncMoveAction(void)
+{
+	int starved = 0;	// Counts consecutive empty passes over the ring buffer.
+	int byteNum = 0;	// Which byte of the current tuple we are waiting on.
+	int skipped = 0;	// Counts the frame's trailing end bytes as they are stepped over.
+	int tuples;			// How many tuples are left in the stream.
+	int moveReady = 0;	// Set once our own tuple has been captured.
+	char tuple[5];		// One tuple: servo ID, position low/high, speed low/high.
+	
+	tuples = COMMAND_PARAM;
+	
+	// Close the interconnect route.  Downstream modules start seeing the stream at
+	// propagation delay while we are still snooping it.
+	LoadConfig_pass_through();
+	
+	// Walk the tuple stream as it flies by.
+	while((tuples > 0) && (starved < STARVE_LIMIT))
+	{
+		if(rxBytesReady())
+		{
+			starved = 0;
+			
+			// The frame's two end bytes arrive ahead of the tuple stream, so step
+			// over them before the tuple accounting starts.
+			if(skipped < 2)
+			{
+				rxGetByte();
+				skipped++;
+				continue;
+			}
+			
+			tuple[byteNum] = rxGetByte();
+			byteNum++;
+			
+			// A whole tuple has gone past.  If it names our servo, keep it.
+			if(byteNum == 5)
+			{
+				if(tuple[0] == ID)
+				{
+					moveReady = 1;
+				}
+				
+				byteNum = 0;
+				tuples--;
+			}
+		}
+		else
+		{
+			starved++;
+		}
+	}
+	
+	// The stream is done (or died); open the route back up.
+	UnloadConfig_pass_through();
+	
+	// Now that the bus work is over, pass our tuple down to the servo.
+	if(moveReady)
+	{
+		servoMove(tuple[1], tuple[2], tuple[3], tuple[4]);
+	}
+}
+
+// The master is offering a warm restart.  If a valid identity cache survives in flash
+// from the last successful configuration, adopt it on the spot and skip the whole
+// discovery dance.  No acknowledgment goes out -- every module on the bus is adopting
+// at the same time, and the master verifies the resumed chain with ordinary pings,
+// falling back to a CLEAR_CONFIG and a full enumeration if anyone fails to answer.
+void resumeAction(void)
+{
+	char cache[4];		// Magic byte, module ID, child port, servo ID.
+	
+	// Pull the cached identity out of flash.
+	CONFIG_STORE_E2Read(CACHE_ADDRESS, cache, 4);
+	
+	// Only adopt a cache that a successful configuration actually wrote.
+	if(cache[0] == CACHE_VALID)
+	{
+		ID = cache[1];			// Take back the assigned ID.
+		CHILD = cache[2];		// Take back the registered child port.
+		SERVO_ID = cache[3];	// Take back the servo ID.
+		CONFIGURED = 1;			// This module is configured again.
+		
+		// Re-enter the wait configuration so the pin routing and the LED pick up the
+		// configured posture.
+		configToggle(WAIT);
+		
+		// The broadcast that got us here stopped here: an unconfigured module
+		// connects nothing but its upstream pin, so whoever is behind us never
+		// heard it.  The configured posture we just adopted has every pin
+		// connected, so say it again downstream and the adoption ripples hop by
+		// hop off the master's one broadcast.
+		if(CHILD)
+		{
+			char packet[10];				// The forwarded resume frame.
+			
+			packet[0] = START_TRANSMIT;		// Start byte one
+			packet[1] = START_TRANSMIT;		// Start byte two
+			packet[2] = MASTER_ID;			// The frame stays the master's (source).
+			packet[3] = BROADCAST;			// Everyone behind us adopts (destination).
+			packet[4] = RESUME;				// This is a resume command.
+			packet[5] = 1;					// One payload byte follows.
+			packet[6] = 0;					// There is no parameter.
+			packet[7] = frameChecksum(MASTER_ID, BROADCAST, RESUME, 1, 0);	// Frame checksum.
+			packet[8] = END_TRANSMIT;		// This is the end of this transmission.
+			packet[9] = END_TRANSMIT;		// This is the end of this transmission.
+			
+			busTransmit();					// Flip the bus around to talk.
+			
+			sendPacket(packet, 10);			// Hand the frame to the transmit interrupt.
+			
+			busReceive();					// Flip the bus back around to listen.
+		}
+	}
+}
+
+// The master wants one of this module's performance counters.  The parameter byte
+// selects the counter; the response carries its value back and leaves it counting.
+void readStatsAction(void)
+{
+	if(COMMAND_DESTINATION == ID)
+	{
+		if(COMMAND_PARAM < STAT_COUNT)
+		{
+			statsResponse(STATS[COMMAND_PARAM]);
+		}
+	}
+}
+
+// The master wants one aggregated acknowledgment for the last broadcast operation.
+// Broadcast commands are consumed and forwarded in a single pass with no per-module
+// round trip, so this sweep is how the master learns whether the whole rig actually
+// carried one out.  The ack originates at the chain tip and flows upstream, with every
+// module ORing its own status bits in as it passes, so the whole rig answers with one
+// packet instead of a round trip per module.
+void ackAction(void)
+{
+	char status;
+	
+	status = MODULE_STATUS;
+	
+	// The servo fault is a standing condition, not an event, so it is folded in fresh
+	// for every sweep instead of living in the status bits that get cleared.
+	if(SERVO_FAULT)
+	{
+		status |= ACK_SERVO_FAULT;
+	}
+	
+	if(CHILD)
+	{
+		// Wait for the child's aggregated ack and fold it into ours.  This is the one
+		// place the child's bytes are consumed locally instead of repeated, because the
+		// running total has to be rewritten before it goes on.  A silent child is
+		// itself news worth passing along.
+		if(childCollect() && (COMMAND_TYPE == BROADCAST_ACK))
+		{
+			status |= COMMAND_PARAM;
+		}
+		else
+		{
+			status |= ACK_CHILD_SILENT;
+		}
+	}
+	
+	// Send the running total upstream.
+	ackResponse(status);
+	
+	// The status has been reported, so start clean for the next operation.
+	MODULE_STATUS = 0;
+}
+
+// The master is moving the controller bus to a new rate tier.  This only ever happens
+// after enumeration, when every link is known good at the base rate.  The addressed
+// module answers at the old rate first, so the master knows the command landed before
+// either end switches; a broadcast switches everyone silently.  The servo leg is not
+// affected -- its fixed rate is restored for every servo configuration by configToggle().
+void setBaudAction(void)
+{
+	if(COMMAND_PARAM <= BAUD_TIER_MAX)
+	{
+		// Answer before the clocks move.
+		if(COMMAND_DESTINATION == ID)
+		{
+			pingResponse();
+		}
+		
+		// Only the addressed module moves (or everyone at once, on a broadcast).
+		// Modules deeper than an addressed target dispatch this frame too, and
+		// switching with it would split the chain across rates until their fallback
+		// dragged them back down.
+		if((COMMAND_DESTINATION == ID) || (COMMAND_DESTINATION == BROADCAST))
+		{
+			BUS_TIER = COMMAND_PARAM;
+			TIER_ERRORS = 0;
+			
+			// Give the frame a moment to finish flying down the chain before the
+			// clock shifts underneath the modules still repeating it.
+			delayUs(200);
+			
+			applyBaudTier(BUS_TIER);
+		}
+	}
+}
+
+// This function programs the clock dividers for a controller bus rate tier.
+void applyBaudTier(char tier)
+{
+	OSC_CR1 = ((VC1_DIVIDER - 1) << 4) | ((VC2_DIVIDER >> tier) - 1);
+}
+
+// This function counts a checksum failure at the negotiated rate.  A few of these in a
+// row means this end can no longer hear the bus reliably, so the module falls back to
+// the tier-zero rate on its own.  The master sees the silence at speed, falls back the
+// same way, and re-raises the tier link by link once the chain answers pings again.
+void tierError(void)
+{
+	if(BUS_TIER)
+	{
+		TIER_ERRORS++;
+		
+		if(TIER_ERRORS >= BAUD_FALL_LIMIT)
+		{
+			BUS_TIER = 0;
+			TIER_ERRORS = 0;
+			
+			applyBaudTier(0);
+		}
+	}
+}
+
+// The master is sweeping the whole chain for health in one broadcast.  A normal ping to
+// module k makes every module ahead of k swap configurations, start a timer, and wait,
+// per hop -- pinging all n modules costs n squared toggles.  Here every module answers
+// the same broadcast in a time slot derived from its ID, with every parent holding the
+// pass-through route closed for the duration, so the whole sweep costs each module one
+// route closure instead of a posture change per hop per ping.  The parameter carries
+// the number of modules being swept, so every module also knows when the sweep is over.
+void sweepPingAction(void)
+{
+	int i;			// An index for counting off the slots of the other modules.
+	
+	if(CONFIGURED)
+	{
+		// Hold the return route closed for the whole sweep.
+		if(CHILD)
+		{
+			LoadConfig_pass_through();
+		}
+		
+		// Wait out the slots of everyone ahead of us.  Their responses fly by on the
+		// hardware route underneath this wait.
+		for(i = 1; i < ID; i++)
+		{
+			delayUs(SWEEP_SLOT_US);
+		}
+		
+		// Throw away the overheard responses so the transmit guard starts clean.
+		rxFlush();
+		
+		pingResponse();
+		
+		// Wait out the slots of everyone behind us before opening the route back up.
+		if(CHILD)
+		{
+			for(i = ID; i < COMMAND_PARAM; i++)
+			{
+				delayUs(SWEEP_SLOT_US);
+			}
+			
+			UnloadConfig_pass_through();
+		}
+		
+		// Drop whatever the deeper responses left in the ring buffer.
+		rxFlush();
+	}
+}
+
+// The master is renumbering part of the chain in place.  The destination byte names
+// the first affected module and the parameter is that module's new ID; every configured
+// module at or behind the destination shifts its own ID by the same difference.  CHILD
+// ports stay as they are and the servo ID is rewritten locally, so replacing one module
+// near the master costs one sweep instead of a CLEAR_CONFIG cascade that deconfigures
+// everything behind it and forces a full re-enumeration.
+void renumberAction(void)
+{
+	char newID;			// The ID this module shifts to.
+	char addressed;		// Whether this module is the one the sweep is aimed at.
+
+	// Everyone from the destination on back applies the shift.  The waiting receivers
+	// forward the frame down the chain on their own, so the whole span hears the same
+	// sweep and nobody has to relay it by hand.
+	if(CONFIGURED && (ID >= COMMAND_DESTINATION))
+	{
+		newID = ID + (COMMAND_PARAM - COMMAND_DESTINATION);
+
+		if((newID > MASTER_ID) && (newID < DEFAULT_ID))
+		{
+			// Decide this before the ID changes out from under the comparison.
+			addressed = (COMMAND_DESTINATION == ID);
+
+			// Take the new ID and drag the servo along through the existing write
+			// path.  The write produces no response, so there is nothing to listen
+			// for.  A faulted servo has nothing to drag: skip the write and leave
+			// the servo ID alone, so no binding gets fabricated (or cached) for a
+			// servo that was never found and the background retry keeps hunting for
+			// the real one.
+			ID = newID;
+			
+			if(!SERVO_FAULT)
+			{
+				servoWrite(SERVO_ID, ID_ADDRESS, ID);
+				SERVO_ID = ID;
+			}
+
+			// Only the directly addressed module answers.  One reply confirms the
+			// sweep without the whole span talking at once, and the master can spot
+			// check the rest with pings.
+			if(addressed)
+			{
+				assignedID();
+			}
+			else
+			{
+				// Get back into the waiting posture after the servo write.
+				configToggle(WAIT);
+			}
+
+			// The cached identity now describes the old numbering, so refresh it.
+			// The flash write parks the CPU for milliseconds, so it follows the
+			// reply the master is waiting on instead of delaying it.
+			cacheStore();
+		}
+	}
+}
+
+// The master is changing the telemetry subscription.  A nonzero parameter arms
+// autonomous position reporting with that many milliseconds per epoch; zero stops it.
+// For the whole session every module with a child keeps the pass-through route closed,
+// so reports from anywhere in the chain reach the master at interconnect speed without
+// anyone toggling into a response configuration.
+void telemetryAction(void)
+{
+	TELEM_EPOCH = COMMAND_PARAM;
+	TELEM_TICK = 0;
+	TELEM_SENT = 0;
+	
+	if(TELEM_EPOCH)
+	{
+		// Hold the return route open for the whole session.
+		if(CHILD)
+		{
+			LoadConfig_pass_through();
+		}
+		
+		WAIT_NC_TIMEOUT_EnableInt();	// Make sure interrupts are enabled.
+		WAIT_NC_TIMEOUT_Start();		// Start the telemetry tick.
+	}
+	else
+	{
+		// The tick also drives the trace clock, so it only stops when both are done.
+		if(!TRACE_ARMED)
+		{
+			WAIT_NC_TIMEOUT_Stop();		// Stop the telemetry tick.
+		}
+		
+		// The session is over, so stop repeating traffic downstream.
+		if(CHILD)
+		{
+			UnloadConfig_pass_through();
+		}
+	}
+}
+
+// The master is arming or disarming this module's bus trace recorder.  Arming clears
+// the ring and starts the millisecond tick; disarming leaves the recorded entries in
+// place for reading.
+void setTraceAction(void)
+{
+	if(COMMAND_DESTINATION == ID)
+	{
+		TRACE_ARMED = COMMAND_PARAM;
+		
+		if(TRACE_ARMED)
+		{
+			// Start the recording over.
+			TRACE_CLOCK = 0;
+			TRACE_HEAD = 0;
+			TRACE_COUNT = 0;
+			
+			WAIT_NC_TIMEOUT_EnableInt();	// Make sure interrupts are enabled.
+			WAIT_NC_TIMEOUT_Start();		// Start the millisecond tick.
+		}
+		else if(!TELEM_EPOCH)
+		{
+			// The tick also drives telemetry, so it only stops when both are done.
+			WAIT_NC_TIMEOUT_Stop();
+		}
+	}
+}
+
+// The master wants one entry out of this module's trace ring.  The parameter picks the
+// entry, counted from the oldest one still held, and the answer carries the whole entry
+// in one multi-byte payload.
+void readTraceAction(void)
+{
+	if(COMMAND_DESTINATION == ID)
+	{
+		if(COMMAND_PARAM < TRACE_COUNT)
+		{
+			traceResponse(COMMAND_PARAM);
+		}
+	}
+}
+
+// The master wants a real measurement of this module's child round trip.  The timeout
+// periods have always been tuned by guesswork: too long and every miss waits the full
+// period, too short and slow responses get dropped.  The parameter names the child, the
+// module fires a master-shaped ping at it, and the child timeout timer runs as a fine
+// stopwatch from the moment the listener comes up until the response has fully passed
+// -- exactly the window the timeout period has to cover.  The measured tick count goes
+// upstream, and a silent child reports the cap so the master knows the present timeout
+// is not long enough to ever see this child.
+void measureAction(void)
+{
+	int responded;
+	
+	if((COMMAND_DESTINATION == ID) && CHILD)
+	{
+		// Fire the probe.  The child answers it exactly as it would answer the
+		// master's own ping passing through.
+		measureProbe(COMMAND_PARAM);
+		
+		// Run the normal repeater wait with the stopwatch armed.
+		MEASURE_TICKS = 0;
+		MEASURING = 1;
+		
+		responded = childResponse();
+		
+		MEASURING = 0;
+		
+		if(responded)
+		{
+			measureResponse(MEASURE_TICKS);
+		}
+		else
+		{
+			measureResponse(MEASURE_LIMIT);
+		}
+	}
+}
+
+// The master is programming this module's child response timeout from a real
+// measurement.  The parameter is the new period in steps of 100 microseconds; zero puts
+// the stock period back.  The configuration loader rewrites the timer's period register
+// on every reload, so the tuned value is kept here and re-applied by every response
+// entry routine instead of being written to the hardware once.
+void setTimeoutAction(void)
+{
+	char steps;
+	
+	if((COMMAND_DESTINATION == ID) || (COMMAND_DESTINATION == BROADCAST))
+	{
+		steps = COMMAND_PARAM;
+		
+		// The period register is sixteen bits of ticks, so the step count is capped
+		// where the arithmetic still fits.
+		if(steps > 100)
+		{
+			steps = 100;
+		}
+		
+		CHILD_PERIOD = steps*(TICKS_PER_US*100);
+	}
+}
+
+// This table maps a controller command code to its handler.  It is indexed by
+// (COMMAND_TYPE - COMMAND_BASE), so command dispatch costs one indexed call no matter
+// how many commands we bolt on, and adding a command is one handler plus one entry here.
+// Empty slots belong to codes that only the master node ever consumes.
+const actionFunc COMMAND_HANDLERS[COMMAND_COUNT] = {
+	helloAction,		// HELLO_BYTE
+	idAssignAction,		// ID_ASSIGNMENT
+	0,					// ID_ASSIGN_OK is only ever consumed by the master.
+	pingAction,			// PING
+	clearConfigAction,	// CLEAR_CONFIG
+	0,					// CONFIG_CLEARED is only ever consumed by the master.
+	syncMoveAction,		// SYNC_MOVE
+	resumeAction,		// RESUME
+	readStatsAction,	// READ_STATS
+	ackAction,			// BROADCAST_ACK
+	telemetryAction,	// TELEMETRY
+	renumberAction,		// RENUMBER
+	setBaudAction,		// SET_BAUD
+	sweepPingAction,	// SWEEP_PING
+	setTraceAction,		// SET_TRACE
+	readTraceAction,	// READ_TRACE
+	measureAction,		// MEASURE
+	setTimeoutAction	// SET_TIMEOUT
+};
+
+// This function interprets what has been read by the command ready function
+// and performs the appropriate action.  Controller commands dispatch through the handler
+// table above; servo instructions take the relay path.
+void takeAction(void)
+{
+	// A frame that the destination byte already routed downstream needs no dispatch at
+	// all; the return route has been open since mid-frame.  All that is left is to watch
+	// the snooped traffic and reopen the route once the exchange goes quiet.
+	if(COMMAND_FORWARD)
+	{
+		COMMAND_FORWARD = 0;
+		routeWatch();
+	}
+	else if((COMMAND_TYPE >= COMMAND_BASE) && (COMMAND_TYPE < (COMMAND_BASE + COMMAND_COUNT)))
+	{
+		// Look up the handler for this controller command and run it if one exists.
+		if(COMMAND_HANDLERS[COMMAND_TYPE - COMMAND_BASE])
+		{
+			COMMAND_HANDLERS[COMMAND_TYPE - COMMAND_BASE]();
+		}
+	}
+	else if((COMMAND_TYPE == PING_SERVO) || (COMMAND_TYPE == READ_SERVO))
+	{
+		// A servo command is passing along the chain.
+		servoRelayAction();
+	}
+}
+
+// This function closes the hardware pass-through route for servo traffic headed past this
+// module.  The pass_through configuration holds no user modules at all -- it just closes
+// the row interconnect between the upstream receive line and the downstream transmit pins
+// -- so it stacks on top of the wait configuration in a handful of register writes and the
+// wait receiver keeps running underneath.  Relayed bytes therefore cost a propagation
+// delay per hop instead of a byte-time, and the CPU's only job is to snoop the line and
+// notice when it has gone quiet.
+void passThrough(void)
+{
+	// Close the interconnect route.  The wait configuration stays loaded underneath.
+	LoadConfig_pass_through();
+	
+	// Watch the exchange and reopen the route once it goes quiet.
+	routeWatch();
+}
+
+// This function watches a pass-through route that is already closed -- either by
+// passThrough() above or by the parser routing a frame the moment its destination byte
+// arrived -- and reopens it once the line has gone quiet.
+void routeWatch(void)
+{
+	int i = 0;			// Counts consecutive passes where the line was silent.
+	int starved = 0;	// Counts passes spent waiting for the response to begin.
+	
+	// The response does not begin the instant the routed frame ends.  The responder
+	// still has to turn its bus around, and its transmit-side ready wait runs a full
+	// millisecond on a routed path, where nobody sends the sentinel.  Counting that
+	// turnaround as silence would reopen the route before the first response byte, so
+	// wait for the response to begin first, bounded the same way the sync-move stream
+	// wait is in case the responder never speaks at all.
+	while((!rxBytesReady()) && (starved < STARVE_LIMIT))
+	{
+		starved++;
+	}
+	
+	// Watch the snooped traffic until no bytes have shown up for RESPONSE_ITERATIONS
+	// passes.  This is the same silence rule the old software relay loop used.
+	while(i < RESPONSE_ITERATIONS)
+	{
+		if(rxBytesReady())
+		{
+			rxGetByte();	// A byte flew by, so the line is still busy.
+			i = 0;
+		}
+		else
+		{
+			i++;
+		}
+	}
+	
+	// The exchange is over.  Open the route back up so that we stop repeating traffic
+	// downstream that is not meant to go there.
+	UnloadConfig_pass_through();
+}
+
+// This function bumps one of the performance counters.  The counters saturate at 255
+// instead of wrapping, so a reading of 255 means "at least this many" rather than a
+// mystery remainder.
+void statBump(int stat)
+{
+	if(STATS[stat] < 255)
+	{
+		STATS[stat]++;
+	}
+}
+
+// This function sends one performance counter value back to the master in an ordinary
+// response frame, with the value riding in the parameter byte.
+void statsResponse(char value)
+{
+	char packet[10];					// The response frame.
+	
+	// Build the response frame.
+	packet[0] = START_TRANSMIT;		// Start byte one
+	packet[1] = START_TRANSMIT;		// Start byte two
+	packet[2] = ID;					// My ID
+	packet[3] = MASTER_ID;			// Destination ID (master)
+	packet[4] = READ_STATS;		// This is a counter read response
+	packet[5] = 1;					// One payload byte follows.
+	packet[6] = value;				// The counter value being returned.
+	packet[7] = frameChecksum(ID, MASTER_ID, READ_STATS, 1, value);	// Frame checksum.
+	packet[8] = END_TRANSMIT;		// This is the end of this transmission
+	packet[9] = END_TRANSMIT;		// This is the end of this transmission
+	
+	busTransmit();					// Flip the bus around to talk.
+	
+	sendPacket(packet, 10);			// Hand the frame to the transmit interrupt.
+	
+	busReceive();					// Flip the bus back around to listen.
+}
+
+// This function files one completed frame into the trace ring.  The timestamp is the
+// millisecond clock reading from the frame's first start byte, so comparing the same
+// frame's entry in two modules' rings measures the hop between them directly.
+void traceFrame(void)
+{
+	if(TRACE_ARMED)
+	{
+		TRACE_STAMP[TRACE_HEAD] = TRACE_MARK;
+		TRACE_TYPE[TRACE_HEAD] = FRAME_TYPE;
+		TRACE_SOURCE[TRACE_HEAD] = FRAME_SOURCE;
+		TRACE_LEN[TRACE_HEAD] = FRAME_LENGTH;
+		
+		TRACE_HEAD = (TRACE_HEAD + 1)%TRACE_SIZE;
+		
+		// Once the ring is full, the oldest entry is the one sacrificed.
+		if(TRACE_COUNT < TRACE_SIZE)
+		{
+			TRACE_COUNT++;
+		}
+	}
+}
+
+// This function sends one trace ring entry upstream.  This is the first frame to use a
+// payload longer than one byte: the timestamp, type, source, and length all ride in a
+// single response instead of a query per field.
+void traceResponse(char index)
+{
+	char packet[14];				// The response frame.
+	int slot;						// Which ring slot the requested entry lives in.
+	int sum;						// Running sum for the checksum.
+	
+	// The requested index counts from the oldest entry still held.
+	slot = (TRACE_HEAD - TRACE_COUNT + index + TRACE_SIZE)%TRACE_SIZE;
+	
+	// Build the response frame around the five-byte entry payload.
+	packet[0] = START_TRANSMIT;		// Start byte one
+	packet[1] = START_TRANSMIT;		// Start byte two
+	packet[2] = ID;					// My ID
+	packet[3] = MASTER_ID;			// Destination ID (master)
+	packet[4] = READ_TRACE;			// This is a trace read response
+	packet[5] = 5;					// Five payload bytes follow.
+	packet[6] = TRACE_STAMP[slot]%256;		// Timestamp low byte.
+	packet[7] = TRACE_STAMP[slot]/256;		// Timestamp high byte.
+	packet[8] = TRACE_TYPE[slot];	// The recorded type byte.
+	packet[9] = TRACE_SOURCE[slot];	// The recorded source ID.
+	packet[10] = TRACE_LEN[slot];	// The recorded length byte.
+	
+	// The checksum runs over the body and the whole payload.
+	sum = ID + MASTER_ID + READ_TRACE + 5;
+	sum += packet[6] + packet[7] + packet[8] + packet[9] + packet[10];
+	
+	packet[11] = 255-(sum%256);		// Frame checksum.
+	packet[12] = END_TRANSMIT;		// This is the end of this transmission
+	packet[13] = END_TRANSMIT;		// This is the end of this transmission
+	
+	busTransmit();					// Flip the bus around to talk.
+	
+	sendPacket(packet, 14);			// Hand the frame to the transmit interrupt.
+	
+	busReceive();					// Flip the bus back around to listen.
+}
+
+// This function fires a master-shaped ping at this module's child.  The transmitters
+// drive every pin, so the probe reaches the child directly; the copy that also travels
+// upstream is addressed to nobody the master cares about and passes as bus noise.
+void measureProbe(char childID)
+{
+	char packet[10];				// The probe frame.
+	
+	// Build a ping the child cannot tell from the master's own.
+	packet[0] = START_TRANSMIT;		// Start byte one
+	packet[1] = START_TRANSMIT;		// Start byte two
+	packet[2] = MASTER_ID;			// The parser only accepts commands from the master.
+	packet[3] = childID;			// The child being probed.
+	packet[4] = PING;				// This is a ping.
+	packet[5] = 1;					// One payload byte follows.
+	packet[6] = 0;					// A ping carries nothing.
+	packet[7] = frameChecksum(MASTER_ID, childID, PING, 1, 0);	// Frame checksum.
+	packet[8] = END_TRANSMIT;		// This is the end of this transmission
+	packet[9] = END_TRANSMIT;		// This is the end of this transmission
+	
+	busTransmit();					// Flip the bus around to talk.
+	
+	sendPacket(packet, 10);			// Hand the frame to the transmit interrupt.
+	
+	busReceive();					// Flip the bus back around to listen.
+}
+
+// This function sends a measured round trip upstream, in stopwatch ticks of fifty
+// microseconds, as a two-byte payload.
+void measureResponse(int ticks)
+{
+	char packet[11];				// The response frame.
+	int sum;						// Running sum for the checksum.
+	
+	// Build the response frame around the two-byte measurement payload.
+	packet[0] = START_TRANSMIT;		// Start byte one
+	packet[1] = START_TRANSMIT;		// Start byte two
+	packet[2] = ID;					// My ID
+	packet[3] = MASTER_ID;			// Destination ID (master)
+	packet[4] = MEASURE;			// This is a measurement response
+	packet[5] = 2;					// Two payload bytes follow.
+	packet[6] = ticks%256;			// Measurement low byte.
+	packet[7] = ticks/256;			// Measurement high byte.
+	
+	// The checksum runs over the body and the whole payload.
+	sum = ID + MASTER_ID + MEASURE + 2 + packet[6] + packet[7];
+	
+	packet[8] = 255-(sum%256);		// Frame checksum.
+	packet[9] = END_TRANSMIT;		// This is the end of this transmission
+	packet[10] = END_TRANSMIT;		// This is the end of this transmission
+	
+	busTransmit();					// Flip the bus around to talk.
+	
+	sendPacket(packet, 11);			// Hand the frame to the transmit interrupt.
+	
+	busReceive();					// Flip the bus back around to listen.
+}
+
+// This function sends the aggregated acknowledgment byte upstream in an ordinary
+// response frame, with the ORed status riding in the parameter byte.
+void ackResponse(char status)
+{
+	char packet[10];					// The response frame.
+	
+	// Build the response frame.
+	packet[0] = START_TRANSMIT;		// Start byte one
+	packet[1] = START_TRANSMIT;		// Start byte two
+	packet[2] = ID;					// My ID
+	packet[3] = MASTER_ID;			// Destination ID (master)
+	packet[4] = BROADCAST_ACK;	// This is an aggregated ack response
+	packet[5] = 1;					// One payload byte follows.
+	packet[6] = status;				// The ORed status of this module and everything below it.
+	packet[7] = frameChecksum(ID, MASTER_ID, BROADCAST_ACK, 1, status);	// Frame checksum.
+	packet[8] = END_TRANSMIT;		// This is the end of this transmission
+	packet[9] = END_TRANSMIT;		// This is the end of this transmission
+	
+	busTransmit();					// Flip the bus around to talk.
+	
+	sendPacket(packet, 10);			// Hand the frame to the transmit interrupt.
+	
+	busReceive();					// Flip the bus back around to listen.
+}
+
+// This function retries a faulted servo in the background.  It runs from the main loop
+// and only spends time when the module is otherwise completely idle, so relaying for
+// the downstream modules is never disturbed.  One broadcast ping per retry window is
+// enough: a servo that has come back answers with its ID, the status return level is
+// put back the way servoFinder() would have left it, and the fault clears on its own.
+void servoRecover(void)
+{
+	if(SERVO_FAULT && (STATE == WAIT) && (!TX_BUSY) && (!CMD_COUNT) && (!rxBytesReady()))
+	{
+		RETRY_WAIT++;
+		
+		if(RETRY_WAIT >= SERVO_RETRY_PASSES)
+		{
+			RETRY_WAIT = 0;
+			
+			// Send a ping out for any servo connected to me (will only be one).
+			servoInstruction(BROADCAST, PING_LENGTH, PING_SERVO, 0, 0);
+			
+			while(!TIMEOUT)
+			{
+				if(commandReady())
+				{
+					if((COMMAND_SOURCE >= SERVO_ID_MIN) && (COMMAND_SOURCE <= SERVO_ID_MAX))
+					{
+						// The servo is back.  Take its ID and restore the status
+						// return level it would have been given at boot.
+						SERVO_ID = COMMAND_SOURCE;
+						
+						servoWrite(SERVO_ID, STATUS_RET_ADDRESS, STATUS_RET_LEVEL);
+						
+						SERVO_FAULT = 0;
+					}
+					
+					// Either way this retry is over.
+					TIMEOUT = 1;
+				}
+			}
+			
+			INIT_TIMEOUT_Stop();	// Stop the receive timeout timer.
+			TIMEOUT = 0;			// Reset the timeout flag.
+			
+			// Get back to listening either way.
+			configToggle(WAIT);
+		}
+	}
+}
+
+// This function drops the core into CPU sleep once the bus has been quiet for a while.
+// Between master transmissions the main loop just spins, holding the core at full clock
+// doing nothing, and with forty-plus modules on one supply that idle burn adds up.  The
+// upstream receive pin is armed to raise the GPIO interrupt when it is pulled low, so
+// the start bit of the next transmission is the wakeup call and the core is listening
+// again within a bit-time.  Sleep is only entered from a completely drained waiting
+// posture -- nothing queued, nothing in flight, no telemetry session -- so waking up
+// always lands back in a clean loop pass.
+void idleSleep(void)
+{
+	// A faulted module stays awake; sleeping would starve the background servo retry.
+	if((STATE == WAIT) && (!TX_BUSY) && (!CMD_COUNT) && (!TELEM_EPOCH) &&
+	   (!SERVO_FAULT) && (!rxBytesReady()))
+	{
+		IDLE_COUNT++;
+		
+		if(IDLE_COUNT >= IDLE_LIMIT)
+		{
+			IDLE_COUNT = 0;
+			
+			// Arm the upstream receive pin to interrupt while it reads low, so the
+			// next start bit wakes us.
+			PRT0IC1 &= 0b11111110;	// Interrupt mode 01 on P00:
+			PRT0IC0 |= 0b00000001;	// assert while the pin reads low.
+			
+			M8C_Sleep;				// Stop the core until the bus falls.
+			
+			// Disarm the pin again so that normal traffic does not hammer the GPIO
+			// interrupt while we are awake.
+			PRT0IC0 &= 0b11111110;	// Interrupt mode 00 on P00: disabled.
+		}
+	}
+	else
+	{
+		// Something is going on, so start the silence count over.
+		IDLE_COUNT = 0;
+	}
+}
+
+// This function runs the telemetry subscription from the main loop.  Every module owns
+// a time slot inside the reporting epoch, staggered by ID so that no two modules talk
+// at once.  When the slot comes up, the servo's present position is read locally and
+// pushed upstream, so the master collects the whole chain's state in one epoch instead
+// of paying a full chain traversal per joint per control tick.
+void telemetryPoll(void)
+{
+	char posLow = 0;	// The low byte of the present position.
+	char posHigh = 0;	// The high byte of the present position.
+	int good = 0;		// Counts the position bytes that read back cleanly.
+	
+	if(TELEM_EPOCH)
+	{
+		// Start the epoch over once the tick has walked off the end of it.
+		if(TELEM_TICK >= TELEM_EPOCH)
+		{
+			TELEM_TICK = 0;
+			TELEM_SENT = 0;
+		}
+		
+		// Fire once per epoch, the moment our slot arrives.  A faulted servo has no
+		// position to report, so its slot simply stays silent.
+		if((!TELEM_SENT) && (!SERVO_FAULT) && (TELEM_TICK >= ((ID - 1)*TELEM_SLOT_MS)))
+		{
+			TELEM_SENT = 1;
+			
+			// Read the present position low byte.
+			servoRead(SERVO_ID, PRESENT_POS_ADDRESS, 1);
+			
+			while(!TIMEOUT)
+			{
+				if(commandReady())
+				{
+					if((COMMAND_SOURCE == SERVO_ID) && (!COMMAND_ERROR))
+					{
+						posLow = COMMAND_PARAM;
+						good++;
+					}
+					
+					TIMEOUT = 1;	// Either way this read is over.
+				}
+			}
+			
+			// Read the present position high byte.
+			servoRead(SERVO_ID, PRESENT_POS_ADDRESS + 1, 1);
+			
+			while(!TIMEOUT)
+			{
+				if(commandReady())
+				{
+					if((COMMAND_SOURCE == SERVO_ID) && (!COMMAND_ERROR))
+					{
+						posHigh = COMMAND_PARAM;
+						good++;
+					}
+					
+					TIMEOUT = 1;	// Either way this read is over.
+				}
+			}
+			
+			INIT_TIMEOUT_Stop();	// Stop the receive timeout timer.
+			TIMEOUT = 0;			// Reset the timeout flag.
+			
+			// Get back into the waiting posture before talking upstream.
+			configToggle(WAIT);
+			
+			// Only a fully clean reading is worth reporting; a missed slot just waits
+			// for the next epoch.
+			if(good == 2)
+			{
+				telemetryReport(posLow, posHigh);
+			}
+		}
+	}
+}
+
+// This function pushes one present position report upstream.  The report is a standard
+// servo status packet -- byte for byte what a master-initiated read would have returned
+// -- so the master parses it with the machinery it already has and tells reports apart
+// by their source ID.
+void telemetryReport(char posLow, char posHigh)
+{
+	char checksum;					// The servo-style checksum.
+	char packet[8];					// The report frame.
+	
+	checksum = 255-((ID + TELEM_LENGTH + posLow + posHigh)%256);
+	
+	packet[0] = SERVO_START;		// Start byte one
+	packet[1] = SERVO_START;		// Start byte two
+	packet[2] = ID;					// The module (and servo) this reading belongs to.
+	packet[3] = TELEM_LENGTH;		// Two parameters plus the standard two.
+	packet[4] = 0;					// No error.
+	packet[5] = posLow;				// Present position low byte.
+	packet[6] = posHigh;			// Present position high byte.
+	packet[7] = checksum;			// This is the checksum.
+	
+	busTransmit();					// Flip the bus around to talk.
+	
+	sendPacket(packet, 8);			// Hand the frame to the transmit interrupt.
+	
+	busReceive();					// Flip the bus back around to listen.
+}
+
+// This function commits the module's identity -- assigned ID, child port, and servo ID
+// -- to the E2PROM block after a successful configuration, so a warm restart can resume
+// it instead of running the whole enumeration again.  The write parks the CPU for a few
+// milliseconds, which is fine at the rate configuration events happen.
+void cacheStore(void)
+{
+	char cache[4];		// Magic byte, module ID, child port, servo ID.
+	
+	cache[0] = CACHE_VALID;
+	cache[1] = ID;
+	cache[2] = CHILD;
+	cache[3] = SERVO_ID;
+	
+	// The last parameter is the die temperature the E2PROM routines use for flash
+	// write timing; room temperature is close enough for this rig.
+	CONFIG_STORE_bE2Write(CACHE_ADDRESS, cache, 4, 25);
+}
+
+// This function invalidates the cached identity by wiping the magic byte, so a resume
+// after a deliberate deconfiguration cannot bring a stale identity back to life.
+void cacheClear(void)
+{
+	char cache[1];
+	
+	cache[0] = 0;
+	
+	CONFIG_STORE_bE2Write(CACHE_ADDRESS, cache, 1, 25);
+}
+
+// This function sends out an acknowledgement of a configuration reset.
+void configCleared(void)
+{
+	char packet[10];					// The response frame.
+	
+	// Build the response frame.
+	packet[0] = START_TRANSMIT;		// Start byte one
+	packet[1] = START_TRANSMIT;		// Start byte two
+	packet[2] = ID;					// My ID
+	packet[3] = MASTER_ID;			// Destination ID (master)
+	packet[4] = CONFIG_CLEARED;	// This is a config cleared response
+	packet[5] = 1;					// One payload byte follows.
+	packet[6] = 0;					// There is no parameter.
+	packet[7] = frameChecksum(ID, MASTER_ID, CONFIG_CLEARED, 1, 0);	// Frame checksum.
+	packet[8] = END_TRANSMIT;		// This is the end of this transmission
+	packet[9] = END_TRANSMIT;		// This is the end of this transmission
+	
+	busTransmit();					// Flip the bus around to talk.
+	
+	sendPacket(packet, 10);			// Hand the frame to the transmit interrupt.
+	
+	busReceive();					// Flip the bus back around to listen.
+}
+
+// This function sends out a ping response for everyone to hear.
+void pingResponse(void)
+{
+	char packet[10];					// The response frame.
+	
+	// Build the response frame.
+	packet[0] = START_TRANSMIT;		// Start byte one
+	packet[1] = START_TRANSMIT;		// Start byte two
+	packet[2] = ID;					// My ID
+	packet[3] = MASTER_ID;			// Destination ID (master)
+	packet[4] = PING;		// This is a ping response
+	packet[5] = 1;					// One payload byte follows.
+	packet[6] = 0;					// There is no parameter.
+	packet[7] = frameChecksum(ID, MASTER_ID, PING, 1, 0);	// Frame checksum.
+	packet[8] = END_TRANSMIT;		// This is the end of this transmission
+	packet[9] = END_TRANSMIT;		// This is the end of this transmission
+	
+	busTransmit();					// Flip the bus around to talk.
+	
+	sendPacket(packet, 10);			// Hand the frame to the transmit interrupt.
+	
+	busReceive();					// Flip the bus back around to listen.
+}
+
+// This function blindly unloads all user configurations. This will be called once,
+// when the system initially has no known state.
+void unloadAllConfigs(void)
+{
+	UnloadConfig_waiting();
+	UnloadConfig_hello1();
+	UnloadConfig_response1();
+	UnloadConfig_response2();
+	UnloadConfig_response3();
+	UnloadConfig_response4();
+	UnloadConfig_initial();
+	UnloadConfig_servo_transmit();
+	UnloadConfig_pass_through();
+}
+
+// This function unloads the configuration corresponding to the config number passed to it.
+// We do this instead of unloadAllConfigs to cut down on set up time.  The unload routine
+// comes straight out of the dispatch table, so this costs one indexed call.
+void unloadConfig(int config_num)
+{
+	if(CONFIG_UNLOAD[config_num])
+	{
+		CONFIG_UNLOAD[config_num]();
+	}
+}
+
+// This function responds that an ID has been assigned to it.
+void assignedID(void)
+{
+	char packet[10];					// The response frame.
+	
+	// Build the response frame.
+	packet[0] = START_TRANSMIT;		// Start byte one
+	packet[1] = START_TRANSMIT;		// Start byte two
+	packet[2] = ID;					// My ID
+	packet[3] = MASTER_ID;			// Destination ID (master)
+	packet[4] = ID_ASSIGN_OK;	// This is an assignment ack response
+	packet[5] = 1;					// One payload byte follows.
+	packet[6] = 0;					// There is no parameter.
+	packet[7] = frameChecksum(ID, MASTER_ID, ID_ASSIGN_OK, 1, 0);	// Frame checksum.
+	packet[8] = END_TRANSMIT;		// This is the end of this transmission
+	packet[9] = END_TRANSMIT;		// This is the end of this transmission
+	
+	busTransmit();					// Flip the bus around to talk.
+	
+	sendPacket(packet, 10);			// Hand the frame to the transmit interrupt.
+	
+	busReceive();					// Flip the bus back around to listen.
+}
+
+// This function originates a hello on the master's behalf.  An unconfigured module
+// answers any hello it hears, no matter who forwarded it.
+void helloProbe(void)
+{
+	char packet[10];					// The hello probe frame.
+	
+	// Build a hello probe on the master's behalf.
+	packet[0] = START_TRANSMIT;		// Start byte one
+	packet[1] = START_TRANSMIT;		// Start byte two
+	packet[2] = MASTER_ID;			// The probe carries the master's ID (source).
+	packet[3] = BROADCAST;			// Any unconfigured child may answer (destination).
+	packet[4] = HELLO_BYTE;			// This is a hello command.
+	packet[5] = 1;					// One payload byte follows.
+	packet[6] = 0;					// There is no parameter.
+	packet[7] = frameChecksum(MASTER_ID, BROADCAST, HELLO_BYTE, 1, 0);	// Frame checksum.
+	packet[8] = END_TRANSMIT;		// This is the end of this transmission.
+	packet[9] = END_TRANSMIT;		// This is the end of this transmission.
+	
+	busTransmit();					// Flip the bus around to talk.
+	
+	sendPacket(packet, 10);			// Hand the frame to the transmit interrupt.
+	
+	busReceive();					// Flip the bus back around to listen.
+}
+
+// This function listens for children and registers the port that they talk to.  A
+// start-bit edge only names a port -- a glitch on a floating pin looks exactly the same
+// -- so the port's own receiver is loaded and a whole valid hello frame is demanded
+// before the child becomes part of this module's identity.
+int childListen(void)
+{
+	configToggle(HELLO_ALL);		// Switch to listen for hellos on all four ports.
+	
+	// Wait to either hear a child or time out.
+	while(!TIMEOUT)
+	{		
+		if(HELLO_PORT)
+		{
+			// Steer the response machinery at the port that spoke.  This is
+			// tentative until the frame below checks out.
+			CHILD = HELLO_PORT;
+			HELLO_PORT = 0;
+			
+			HELLO_TIMEOUT_1_Stop();	// The edge hunt is over either way.
+			TIMEOUT = 0;
+			
+			// The edge was the start bit of a hello that nobody could receive yet.
+			// Let that frame clear the wire, then solicit a fresh one with the
+			// port's receiver actually listening.
+			delayUs(2000);
+			
+			helloProbe();
+			
+			// A whole parsed hello is the bar for registering the child.
+			if(childCollect() && (COMMAND_TYPE == HELLO_BYTE) && (!COMMAND_ERROR))
+			{
+				return 1;
+			}
+			
+			CHILD = 0;				// A glitch on a floating pin is not a child.
+			
+			return 0;
+		}
+	}
+	
+	HELLO_TIMEOUT_1_Stop();			// Stop the timer.
+	
+	TIMEOUT = 0;					// Clear the timeout flag.
+	
+	configToggle(WAIT);				// Switch back to wait for a master response.
+	
+	return 0;						// Return the result of our listening session.
+}
+
+// This function probes this module's child ports the moment our own ID assignment has
+// been acknowledged, instead of sitting idle until the master's next hello sweep.  We
+// originate a hello on the master's behalf, then listen on both port groups for an
+// answer.  The master is busy assigning IDs upstream while this runs, so discovery of
+// the next module overlaps with configuration of this one, and total configuration time
+// scales with chain depth rather than with the number of full sweeps.
+void childProbe(void)
+{
+	// Originate a hello on the master's behalf.
+	helloProbe();
+	
+	// Listen for a reply on all four child ports at once.
+	childListen();
+	
+	// If someone answered, forward the hello upstream with the port number added so the
+	// master can start assigning the next ID without another sweep.
+	if(CHILD)
+	{
+		sayHello();
+		
+		// The registered child belongs in the identity cache too.  The flash write
+		// parks the CPU for milliseconds, so it follows the hello instead of
+		// delaying it.
+		cacheStore();
+	}
+}
+
+// This function repeats a known child's response upstream.  The hardware row is what
+// actually carries the bytes to the master; the CPU never reads them, it only waits for
+// the interrupt-side byte counter to call the frame complete.  On a long chain this is
+// the path ping latency accumulates on, so the per-byte work has to stay off it.
+int childResponse(void)
+{
+	return childWait(1);
+}
+
+// This function waits for a known child's response and runs it through the normal
+// parser, for the few callers that need the frame's contents and not just its passage.
+int childCollect(void)
+{
+	return childWait(0);
+}
+
+// This function is the common skeleton behind the two child waits: load the right
+// response configuration, tell the child to go ahead, wait for the whole frame or a
+// timeout, and put everything back.
+int childWait(int repeat)
+{
+	int child_responded = 0;
+	
+	// A broadcast can walk a handler in here on a module with no child registered at
+	// all.  With no port to load, nothing below could ever set the completion or
+	// timeout flags, so the wait would spin forever; there is simply no one to hear.
+	if(!CHILD)
+	{
+		return 0;
+	}
+	
+	// Arm or disarm the repeater before the child's receiver comes up.
+	RESP_REPEAT = repeat;
+	RESP_COUNT = 0;
+	RESP_EXPECT = 0;
+	RESP_DONE = 0;
+	
+	// Switch to the right port.
+	if(CHILD == PORT_A)
+	{
+		configToggle(RESPONSE_1);
+	}
+	else if(CHILD == PORT_B)
+	{
+		configToggle(RESPONSE_2);
+	}
+	else if(CHILD == PORT_C)
+	{
+		configToggle(RESPONSE_3);
+	}
+	else if(CHILD == PORT_D)
+	{
+		configToggle(RESPONSE_4);
+	}
+	
+	// Tell the child its listener is up.  The child's busTransmit() is spinning on this
+	// sentinel right now, so the response starts the moment it lands.
+	signalReady();
+	
+	if(repeat)
+	{
+		// The row is doing the forwarding; just wait for the counter or a timeout.
+		while((!RESP_DONE) && (!TIMEOUT))
+		{
+			// While the stopwatch runs the timer counts instead of timing out, so
+			// the tick cap is the timeout.
+			if(MEASURING && (MEASURE_TICKS >= MEASURE_LIMIT))
+			{
+				TIMEOUT = 1;
+			}
+		}
+		
+		child_responded = RESP_DONE;
+	}
+	else
+	{
+		// Wait for a fully parsed response or a timeout.
+		while((!child_responded) && (!TIMEOUT))
+		{
+			if(commandReady())
+			{
+				child_responded = 1;
+			}
+		}
+	}
+	
+	// The response window is over either way.
+	RESP_REPEAT = 0;
+	
+	// Stop the right timer.
+	if(CHILD == PORT_A)
+	{
+		CHILD_1_TIMEOUT_Stop();
+	}
+	else if(CHILD == PORT_B)
+	{
+		CHILD_2_TIMEOUT_Stop();
+	}
+	else if(CHILD == PORT_C)
+	{
+		CHILD_3_TIMEOUT_Stop();
+	}
+	else if(CHILD == PORT_D)
+	{
+		CHILD_4_TIMEOUT_Stop();
+	}
+	
+	TIMEOUT = 0;					// Reset the timeout flag.
+	
+	// A silent child is the other classic time sink, so count those too.
+	if(!child_responded)
+	{
+		statBump(STAT_CHILD_TIMEOUTS);
+	}
+	
+	configToggle(WAIT);				// Switch back to wait for a master response.
+	
+	return child_responded;
+}
+
+// This function is used to find the servo that is directly connected to this module's controller.
+// After the servo ID is found, the status return level is changed so that packets are only
+// returned for the desired status return level defined at the top of this file.
+void servoFinder(void)
+{				
+	// Index variables for incrementing and checking against the maximum servo comm attempts.
+	int i = 0;
+	int j = 0;
+	
+	int total_attempts = 0;
+	
+	// Integer used as a flag so that EEPROM writes aren't done more than once.
+	int flashWrite = 0;
+	
+	// Create a status return level variable and set it to an out of range value initially.
+	char status_return_level = 3;
+	
+	// Start with a servo ID of 255 (out of valid range).
+	SERVO_ID = SERVO_START;
+
+	// We have to wait for the servo to power up and get ready for communications.
+	servoBootWait();
+
+	// This for loop will loop SERVO_COMM_LOOPS number of times and ping the servo SERVO_COMM_ATTEMPTS
+	// number of times in each loop (unless stopped short due to early success).  If this fails for the
+	// first round of pings, a broadcast reset will be performed to reset the servo.  This is done
+	// because we assume that the baud rate is matching up, but the servo's return delay time is too
+	// fast for the controller to switch into receive mode to read the response.  The default return
+	// delay time is 500 microseconds. If we loop for SERVO_COMM_LOOPS number of times and still don't
+	// see anything, we assume that there is something is too wrong for us to fix.
+	// If the boot probe already heard from the servo, the whole sweep is skipped.
+	for(j = 0; (j < SERVO_COMM_LOOPS) && (SERVO_ID == SERVO_START); j++)
+	{	
+		// Ping SERVO_COMM_ATTEMPTS times to try and extract the servo ID.
+		for(i = 0; i < SERVO_COMM_ATTEMPTS; i++)
+		{
+			// Send a ping out for any servo connected to me (will only be one).
+			servoInstruction(BROADCAST, PING_LENGTH, PING_SERVO, 0, 0);
+			
+			total_attempts++;
+			
+			// Wait for either a timeout or a valid servo ID (which will trigger a timeout).
+			while(!TIMEOUT)
+			{	
+				if(commandReady())
+				{
+					// If we read a source ID within the range, exit the loop.
+					if((COMMAND_SOURCE >= SERVO_ID_MIN) && (COMMAND_SOURCE <= SERVO_ID_MAX))
+					{	
+						// Exit this while loop by setting the timeout flag.
+						TIMEOUT = 1;
+						// Set the servo ID variable to where the ping came from.
+						SERVO_ID = COMMAND_SOURCE;
+						// Set the index variable such that the for loop exits.
+						i = SERVO_COMM_ATTEMPTS;
+						// Set the outer index variable to 2 to not attempt again for no reason.
+						j = SERVO_COMM_LOOPS;
+					}
+					else
+					{
+						// Exit this while loop and try to ping again.
+						TIMEOUT = 1;
+					}
+				}
+			}
+		}
+		
+		// If we didn't get a response and haven't written to the flash of the
+		// servo (first time through), send out a broadcast reset.
+		if((SERVO_ID == SERVO_START) && (!flashWrite))
+		{
+			// Set the flash write flag so that we only do this once per power cycle.
+			flashWrite = 1;
+			
+			// Send out a broadcast reset so that we know that the response time interval
+			// is large enough (default delay time for a servo is 500 microseconds).
+			// Nothing answers a broadcast reset, so fire and forget.
+			servoTransmit(BROADCAST, RESET_LENGTH, RESET_SERVO, 0, 0);
+		}
+	}
+
+	// Reset flash write flag.
+	flashWrite = 0;
+	
+	// If we have a valid servo ID, set the status return level.  If we don't, just skip this
+	// because all hope is lost.
+	if(SERVO_ID < BROADCAST)
+	{
+		// This for loop will loop SERVO_COMM_LOOPS number of times and poll for the servo's status
+		// return level SERVO_COMM_ATTEMPTS number of times in each loop (unless stopped short due
+		// to early success).  If this fails for the first iteration, or we read a status return level
+		// other than what we want, we will attempt to write the desired status return level onto the servo.
+		for(j = 0; j < SERVO_COMM_LOOPS; j++)
+		{
+			// Attempt to read the status return level for the defined number of attempts.
+			for(i = 0; i < SERVO_COMM_ATTEMPTS; i++)
+			{
+				// Send a request for the servo's status return level.
+				servoRead(SERVO_ID, STATUS_RET_ADDRESS, 1);
+				
+				// Wait for either a timeout or an indication that we want to exit the loop.
+				while(!TIMEOUT)
+				{
+					// If a valid command is ready, interpret it.
+					if(commandReady())
+					{
+						if(!COMMAND_ERROR)
+						{
+							// If the return level is equal to what is desired, store it.
+							if(COMMAND_PARAM == STATUS_RET_LEVEL)
+							{
+								// Set the timeout flag to exit the loop.
+								TIMEOUT = 1;
+								// Store the status return level.
+								status_return_level = COMMAND_PARAM;
+								// Set i so that we exit the for loop.
+								i = SERVO_COMM_ATTEMPTS;
+								// Set the outer loop's variable so that we don't loop again.
+								j = SERVO_COMM_LOOPS;
+							}
+							else
+							{	
+								// Set the timeout flag to exit the loop.
+								TIMEOUT = 1;
+							}
+						}
+					}
+				}
+			}
+		
+			// If we didn't get a good response and haven't written to the flash of the servo,
+			// force a change in the status return level with an EEPROM write.
+			if((status_return_level != STATUS_RET_LEVEL) && (!flashWrite))
+			{	
+				flashWrite = 1;
+				
+				// Try to force the return status to what we want.  No response comes
+				// back from a write, so don't burn a toggle waiting for one.
+				servoWrite(SERVO_ID, STATUS_RET_ADDRESS, STATUS_RET_LEVEL);
+			}
+		}
+		
+		if(status_return_level != STATUS_RET_LEVEL)
+		{
+			// The servo answers but will not take the status return level.  Declare
+			// the fault and carry on -- this module can still enumerate and relay, and
+			// the master hears about the joint through the hello byte and the acks.
+			SERVO_FAULT = 1;
+		}
+	}
+	else
+	{
+		// The servo never answered at all.  This used to park the module in an
+		// intentional lockup, which took every downstream module with it and looked
+		// like a wiring fault from the master's end.  Declaring the fault instead
+		// turns a rig-stopping event into a single dead joint; the background retry
+		// keeps looking for the servo between packets.
+		SERVO_FAULT = 1;
+	}
+
+	// Publish how many pings the search really took, so SERVO_COMM_ATTEMPTS can be
+	// tuned against measurements instead of guesses.
+	if(total_attempts > 255)
+	{
+		total_attempts = 255;
+	}
+	
+	STATS[STAT_SERVO_RETRIES] = total_attempts;
+	
+	// Wait for the other controllers to find their servos.
+	servoConfigWait();
+}
+
+// This function receives a destination, command length, instruction type, address, and
+// value, and sends that frame to the servo bus.  It leaves the servo transmit
+// configuration loaded when it returns, so back-to-back instructions pay for one
+// configuration toggle instead of one each; whoever expects a response toggles into the
+// initialization receiver afterwards.
+void servoTransmit(char id, char length, char instruction, char address, char value)
+{
+	char checksum;
+	
+	// Toggle into transmit mode if we are not already there.
+	if(STATE != SERVO_COMM)
+	{
+		configToggle(SERVO_COMM);
+	}
+	
+	// Calculate the checksum value for our servo communication.
+	checksum = 255-((id + length + instruction + address + value)%256);
+	
+	// Talk to the servo.
+	if(instruction == PING_SERVO)
+	{
+		SERVO_TX_PutChar(SERVO_START);	// Start byte one
+		SERVO_TX_PutChar(SERVO_START);	// Start byte two
+		SERVO_TX_PutChar(id);			// Servo ID
+		SERVO_TX_PutChar(length);		// The instruction length.
+		SERVO_TX_PutChar(instruction);	// The instruction to carry out.
+		SERVO_TX_PutChar(checksum);		// This is the checksum.
+	}
+	else
+	{
+		SERVO_TX_PutChar(SERVO_START);	// Start byte one
+		SERVO_TX_PutChar(SERVO_START);	// Start byte two
+		SERVO_TX_PutChar(id);			// Servo ID
+		SERVO_TX_PutChar(length);		// The instruction length.
+		SERVO_TX_PutChar(instruction);	// The instruction to carry out.
+		SERVO_TX_PutChar(address);		// The address to read/write from/to.
+		SERVO_TX_PutChar(value);		// The value to write or number of bytes to read.
+		SERVO_TX_PutChar(checksum);		// This is the checksum.
+	}
+	
+	// Wait for the transmission to finish.
+	while(!(SERVO_TX_bReadTxStatus() & SERVO_TX_TX_COMPLETE));
+	
+	// Make completely sure we're done.
+	xmitWait();
+}
+
+// This function fires a register write at the servo and forgets about it.  With the
+// status return level set to answer reads only, a write produces no response at all,
+// so the old trip through the initialization receiver spent a configuration toggle
+// listening for silence.  The transmit configuration stays loaded for whatever servo
+// work comes next.
+void servoWrite(char id, char address, char value)
+{
+	servoTransmit(id, WRITE_LENGTH, WRITE_SERVO, address, value);
+}
+
+// This function fires a register read at the servo and arms the initialization
+// receiver for the status packet.  The caller picks the answer up with commandReady();
+// the error byte lands in COMMAND_ERROR and the payload in COMMAND_PARAM.
+void servoRead(char id, char address, char count)
+{
+	servoTransmit(id, READ_LENGTH, READ_SERVO, address, count);
+	
+	// Switch back to wait for the servo response.
+	configToggle(INITIALIZE);
+}
+
+// This function carries out the passed servo instruction and then waits for whatever
+// the servo answers.  The read and write paths above are cheaper when they apply; this
+// stays for pings and anything else that needs the general form.
+void servoInstruction(char id, char length, char instruction, char address, char value)
+{
+	servoTransmit(id, length, instruction, address, value);
+	
+	// Switch back to wait for a servo response.
+	configToggle(INITIALIZE);
+}
+
+// This function writes a goal position and moving speed to this module's servo in a
+// single WRITE_SERVO instruction starting at the goal position address.  The status
+// return level only answers reads, so no response is coming and we go straight back to
+// waiting instead of toggling into the initialization receiver.
+void servoMove(char posLow, char posHigh, char speedLow, char speedHigh)
+{
+	char checksum;
+	
+	// Toggle into transmit mode.
+	configToggle(SERVO_COMM);
+	
+	// Calculate the checksum value for our servo communication.
+	checksum = 255-((SERVO_ID + MOVE_LENGTH + WRITE_SERVO + GOAL_ADDRESS
+					+ posLow + posHigh + speedLow + speedHigh)%256);
+	
+	// Talk to the servo.
+	SERVO_TX_PutChar(SERVO_START);	// Start byte one
+	SERVO_TX_PutChar(SERVO_START);	// Start byte two
+	SERVO_TX_PutChar(SERVO_ID);		// Servo ID
+	SERVO_TX_PutChar(MOVE_LENGTH);	// The instruction length.
+	SERVO_TX_PutChar(WRITE_SERVO);	// The instruction to carry out.
+	SERVO_TX_PutChar(GOAL_ADDRESS);	// The address where goal position starts.
+	SERVO_TX_PutChar(posLow);		// Goal position low byte.
+	SERVO_TX_PutChar(posHigh);		// Goal position high byte.
+	SERVO_TX_PutChar(speedLow);		// Moving speed low byte.
+	SERVO_TX_PutChar(speedHigh);	// Moving speed high byte.
+	SERVO_TX_PutChar(checksum);		// This is the checksum.
+	
+	// Wait for the transmission to finish.
+	while(!(SERVO_TX_bReadTxStatus() & SERVO_TX_TX_COMPLETE));
+	
+	// Make completely sure we're done.
+	xmitWait();
+	
+	// Switch back to wait for the next command.
+	configToggle(WAIT);
+}
+
+// This function parks the CPU for the passed number of microseconds on the transmit
+// timeout timer.  The timer counts a known clock, so the delay stays put no matter what
+// the compiler and optimizer do to the surrounding code -- unlike the empty for loop
+// this replaced, whose "approximately 50 microseconds" was really a guess about how
+// much of the loop survived compilation.
+void delayUs(int microseconds)
+{
+	// Scale the request into timer ticks and restart the timer on that period.
+	TX_01234_TIMEOUT_WritePeriod(microseconds * TICKS_PER_US);
+	
+	TIMEOUT = 0;
+	TX_01234_TIMEOUT_EnableInt();		// Make sure interrupts are enabled.
+	TX_01234_TIMEOUT_Start();			// Start the timer.
+	
+	while(!TIMEOUT) { }
+	
+	TX_01234_TIMEOUT_Stop();			// Stop the timer.
+	TIMEOUT = 0;						// Reset the timeout flag.
+	
+	// Put the standard one millisecond period back for the timer's other users.
+	TX_01234_TIMEOUT_WritePeriod(TX_TIMEOUT_PERIOD);
+}
+
+// This function waits out the tail of a transmission after the hardware raises its
+// transmit complete flag.  The guard is exactly one stop bit of line margin derived
+// from the baud rate, so the next start bit can never land inside our final byte, and
+// nobody over-waits on every single packet to buy safety.
+void xmitWait(void)
+{
+	delayUs(TX_TAIL_US);
+}
+
+// This function probes for the servo attached to this controller while it boots up.
+// The estimated boot time in testing was approximately 120 ms, but it varies, so instead
+// of blindly waiting out the worst case we ping at every timeout period from power-on and
+// exit the moment a valid status packet arrives.  Whoever answers is remembered in
+// SERVO_ID so that servoFinder() can skip its own ping sweep entirely.
+void servoBootWait(void)
+{
+	int i = 0;					// Index integer used for looping.
+
+	configToggle(INITIALIZE);	// Switch to initialize mode to do this probe routine.
+	
+	// Probe until the servo answers or we have waited out the worst-case boot time.
+	for(i = 0; i < SERVO_BOOT_TIMEOUTS; i++)
+	{
+		// Send a ping out for any servo connected to me (will only be one).
+		servoInstruction(BROADCAST, PING_LENGTH, PING_SERVO, 0, 0);
+		
+		// Watch for an answer for one timeout period.
+		while(!TIMEOUT)
+		{
+			if(commandReady())
+			{
+				// If we read a source ID within the range, the servo is awake.
+				if((COMMAND_SOURCE >= SERVO_ID_MIN) && (COMMAND_SOURCE <= SERVO_ID_MAX))
+				{
+					// Remember who answered so the ping sweep can be skipped.
+					SERVO_ID = COMMAND_SOURCE;
+					// Set the index variable such that the probe loop exits.
+					i = SERVO_BOOT_TIMEOUTS;
+					// Set the timeout flag to exit this wait as well.
+					TIMEOUT = 1;
+				}
+			}
+		}
+		
+		TIMEOUT = 0;			// Reset the timeout flag.
+	}
+	
+	INIT_TIMEOUT_Stop();		// Stop the timeout timer.
+	TIMEOUT = 0;				// Clear the timeout flag.
+}
+
+// Waits for the chain to come ready instead of spinning out a worst-case setup time.
+// We sit in the wait configuration until the first upstream traffic arrives.  An
+// unconfigured module connects nothing but its upstream pin, so nothing is driven at a
+// child that is still talking to its own servo.  The master's opening hello is the
+// chain-ready signal, so the wait lasts exactly as long as the modules ahead of us
+// actually need rather than a fixed worst case.  No configuration toggle follows the
+// first byte, so the frame that ends the wait stays in the ring buffer for the main
+// loop to parse -- toggling out from under it was how every module used to lose its
+// first-heard frame and cost the rig an extra sweep.
+void servoConfigWait(void)
+{
+	configToggle(WAIT);			// Switch to wait for the master node to speak to you.
+	
+	// Do nothing until the first byte of upstream traffic lands in the ring buffer.
+	// The byte, and the rest of its frame behind it, stays queued for the main loop.
+	while(!rxBytesReady()) { }
+}
+
+// This timeout ISR is the millisecond tick behind both telemetry and the bus trace
+// recorder.  It fires once a millisecond while either is active.
+void WAIT_NC_TIMEOUT_ISR(void)
+{
+	TELEM_TICK++;	// One more millisecond of the epoch has passed.
+	TRACE_CLOCK++;	// The trace clock shares the same tick.
+	M8C_ClearIntFlag(INT_CLR0,WAIT_NC_TIMEOUT_INT_MASK);
+}
+
+// This timeout ISR is for waiting before a transmission is made from this module.
+// This is to give all the other modules a chance to set up and clear their buffers.
+// It is currently set so that there is 1 ms of down time between the last transmission
+// and this module's transmission.
+void TX_01234_TIMEOUT_ISR(void)
+{
+	TIMEOUT = 1;	// Set the timeout flag.
+	M8C_ClearIntFlag(INT_CLR0,TX_01234_TIMEOUT_INT_MASK);
+}
+
+// This is the ISR for the hello response timeout.
+void HELLO_TIMEOUT_1_ISR(void)
+{
+	TIMEOUT = 1;	// Set the timeout flag.
+	M8C_ClearIntFlag(INT_CLR0,HELLO_TIMEOUT_1_INT_MASK);
+}
+
+// This is the GPIO interrupt.  In the hello configuration the child pins are set up for
+// falling-edge interrupts, so a child's start bit lands us here.  Reading the port data
+// register tells us which pin is being pulled low, and that pin is the port the child
+// is connected to.  Outside of hello listening this interrupt is left to normal traffic.
+void GPIO_ISR(void)
+{
+	if(STATE == HELLO_ALL)
+	{
+		if(!(PRT0DR & 0b00000010))		// Pin P01 is low.
+		{
+			HELLO_PORT = PORT_A;
+		}
+		else if(!(PRT0DR & 0b00000100))	// Pin P02 is low.
+		{
+			HELLO_PORT = PORT_B;
+		}
+		else if(!(PRT0DR & 0b00001000))	// Pin P03 is low.
+		{
+			HELLO_PORT = PORT_C;
+		}
+		else if(!(PRT0DR & 0b00010000))	// Pin P04 is low.
+		{
+			HELLO_PORT = PORT_D;
+		}
+	}
+}
+
+// These remaining ISRs are for all the child timeout scenarios.
+void CHILD_1_TIMEOUT_ISR(void)
+{
+	if(MEASURING)
+	{
+		MEASURE_TICKS++;	// The timer is a stopwatch right now, so count the tick.
+	}
+	else
+	{
+		TIMEOUT = 1;	// Set the timeout flag.
+	}
+	
+	M8C_ClearIntFlag(INT_CLR0,CHILD_1_TIMEOUT_INT_MASK);
+}
+
+void CHILD_2_TIMEOUT_ISR(void)
+{
+	if(MEASURING)
+	{
+		MEASURE_TICKS++;	// The timer is a stopwatch right now, so count the tick.
+	}
+	else
+	{
+		TIMEOUT = 1;	// Set the timeout flag.
+	}
+	
+	M8C_ClearIntFlag(INT_CLR0,CHILD_2_TIMEOUT_INT_MASK);
+}
+
+void CHILD_3_TIMEOUT_ISR(void)
+{
+	if(MEASURING)
+	{
+		MEASURE_TICKS++;	// The timer is a stopwatch right now, so count the tick.
+	}
+	else
+	{
+		TIMEOUT = 1;	// Set the timeout flag.
+	}
+	
+	M8C_ClearIntFlag(INT_CLR0,CHILD_3_TIMEOUT_INT_MASK);
+}
+
+void CHILD_4_TIMEOUT_ISR(void)
+{
+	if(MEASURING)
+	{
+		MEASURE_TICKS++;	// The timer is a stopwatch right now, so count the tick.
+	}
+	else
+	{
+		TIMEOUT = 1;	// Set the timeout flag.
+	}
+	
+	M8C_ClearIntFlag(INT_CLR0,CHILD_4_TIMEOUT_INT_MASK);
+}
+
+void INIT_TIMEOUT_ISR(void)
+{
+	TIMEOUT = 1;	// Set the timeout flag.
+	M8C_ClearIntFlag(INT_CLR0,INIT_TIMEOUT_INT_MASK);
+}
+
+// This is the transmit interrupt that drains the outgoing packet buffer.  It fires when
+// the byte in the shifter has completely gone out, at which point the next byte of the
+// frame is dropped into both transmitters.  When the last byte has cleared, the busy flag
+// is released and busReceive() is free to turn the bus around.
+void TX_014_TX_ISR(void)
+{
+	TX_INDEX++;		// The byte at the old index has finished transmitting.
+	
+	if(TX_INDEX < TX_LENGTH)
+	{
+		// Feed the next byte of the frame to both transmitters.
+		TX_014_SendData(TX_BUFFER[TX_INDEX]);
+		TX_23_SendData(TX_BUFFER[TX_INDEX]);
+	}
+	else
+	{
+		// The whole frame has cleared the wire.
+		TX_BUSY = 0;
+	}
+}
+
+// This function is the interrupt-side byte counter behind the response repeater.  Both
+// frame formats announce their own length: a controller frame carries its payload length
+// right after the type byte, and a servo status packet carries one right after its
+// header.  Counting is all the work the interrupt does; the bytes themselves
+// ride the hardware row upstream untouched.
+void repeatByte(char newByte)
+{
+	if(RESP_COUNT == 0)
+	{
+		// Stray bytes can lead the frame -- a deeper parent's ready sentinel drives
+		// every pin, including its upstream one -- so ignore anything that is not a
+		// frame start, the way the parser's idle state does.  Misreading a sentinel
+		// as the format byte would miscount the whole frame behind it.
+		if((newByte != START_TRANSMIT) && (newByte != SERVO_START))
+		{
+			return;
+		}
+		
+		// The first byte names the format; both carry a length byte further in.
+		RESP_FORMAT = (newByte == START_TRANSMIT);
+		RESP_EXPECT = 0;
+	}
+	else if((RESP_COUNT == 3) && (!RESP_FORMAT) && (!RESP_EXPECT))
+	{
+		// A servo status packet is two start bytes, an ID, this length byte, and then
+		// length more bytes.
+		RESP_EXPECT = newByte + 4;
+	}
+	else if((RESP_COUNT == 5) && RESP_FORMAT && (!RESP_EXPECT))
+	{
+		// A controller frame is nine bytes of framing around this many payload bytes.
+		RESP_EXPECT = newByte + 9;
+	}
+	
+	RESP_COUNT++;
+	
+	if(RESP_EXPECT && (RESP_COUNT >= RESP_EXPECT))
+	{
+		RESP_DONE = 1;					// The whole frame has gone by.
+	}
+}
+
+// These are the receive interrupts that feed the ring buffer.  Each one pulls the byte
+// out of its receiver's data register and drops it in the buffer, which is all the work
+// we can afford at interrupt time.  Only the receiver belonging to the currently-loaded
+// configuration ever fires, so they can all share one buffer safely.
+void WAIT_RECV_RX_ISR(void)
+{
+	RX_BUFFER[RX_WRITE] = WAIT_RECV_bReadRxData();	// Grab the byte from the hardware.
+	RX_WRITE = (RX_WRITE + 1) & RX_BUFFER_MASK;		// Advance the index with wrap-around.
+}
+
+void INIT_RX_RX_ISR(void)
+{
+	RX_BUFFER[RX_WRITE] = INIT_RX_bReadRxData();	// Grab the byte from the hardware.
+	RX_WRITE = (RX_WRITE + 1) & RX_BUFFER_MASK;		// Advance the index with wrap-around.
+}
+
+void CHILD_1_RX_ISR(void)
+{
+	if(RESP_REPEAT)
+	{
+		repeatByte(CHILD_1_bReadRxData());			// Just count the byte going by.
+	}
+	else
+	{
+		RX_BUFFER[RX_WRITE] = CHILD_1_bReadRxData();	// Grab the byte from the hardware.
+		RX_WRITE = (RX_WRITE + 1) & RX_BUFFER_MASK;		// Advance the index with wrap-around.
+	}
+}
+
+void CHILD_2_RX_ISR(void)
+{
+	if(RESP_REPEAT)
+	{
+		repeatByte(CHILD_2_bReadRxData());			// Just count the byte going by.
+	}
+	else
+	{
+		RX_BUFFER[RX_WRITE] = CHILD_2_bReadRxData();	// Grab the byte from the hardware.
+		RX_WRITE = (RX_WRITE + 1) & RX_BUFFER_MASK;		// Advance the index with wrap-around.
+	}
+}
+
+void CHILD_3_RX_ISR(void)
+{
+	if(RESP_REPEAT)
+	{
+		repeatByte(CHILD_3_bReadRxData());			// Just count the byte going by.
+	}
+	else
+	{
+		RX_BUFFER[RX_WRITE] = CHILD_3_bReadRxData();	// Grab the byte from the hardware.
+		RX_WRITE = (RX_WRITE + 1) & RX_BUFFER_MASK;		// Advance the index with wrap-around.
+	}
+}
+
+void CHILD_4_RX_ISR(void)
+{
+	if(RESP_REPEAT)
+	{
+		repeatByte(CHILD_4_bReadRxData());			// Just count the byte going by.
+	}
+	else
+	{
+		RX_BUFFER[RX_WRITE] = CHILD_4_bReadRxData();	// Grab the byte from the hardware.
+		RX_WRITE = (RX_WRITE + 1) & RX_BUFFER_MASK;		// Advance the index with wrap-around.
+	}
 }
\ No newline at end of file
@@ -0,0 +1,117 @@
+// File: protocol.h
+//
+// This is the single definition of everything that crosses the inter-controller bus.
+// The module firmware and the master firmware both include this file, so a constant
+// changed or a command added here exists on both ends of the bus at the next build --
+// there is no second copy to hand-mirror, and no way for the two to drift apart.
+//
+// Packet Structure
+// ----------------
+// START BYTE/START BYTE/SOURCE ID BYTE/DESTINATION ID BYTE/COMMAND TYPE/LENGTH/PAYLOAD 1/.../PAYLOAD N/CHECKSUM/END TRANSMIT/END TRANSMIT
+
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+// These defines are used as transmission indicators for transmissions between PSoC controllers.
+#define		START_TRANSMIT				(252)	// Indicates the beginning of a transmission.
+#define		END_TRANSMIT				(253)	// Indicates the end of a transmission.
+
+// This sentinel byte is fired by a listener the moment its configuration is loaded, so
+// the module about to respond can start talking right away instead of sitting out a
+// blind worst-case delay.  It is never part of a frame, so a parser at rest ignores it.
+#define		READY_BYTE					(250)
+
+// These are the reserved controller IDs.
+#define		MASTER_ID					(0)		// The master node's ID.
+#define		DEFAULT_ID					(251)	// The ID that all modules start with.
+#define		BROADCAST					(254)	// The broadcast ID for all controllers and servos.
+
+// The largest controller frame payload.  A full frame is the payload plus nine bytes of
+// framing, and every transmit and receive buffer on the bus is sized around this.
+#define		PAYLOAD_MAX					(7)
+
+// This list is the controller command set.  Each entry is one command: its name, its
+// code on the wire, and the payload length its frames carry (0 means any length is
+// legal).  A command whose reply carries a different payload length under the same type
+// code is marked 0, since both directions are checked against the one table.  The codes
+// are a dense block starting at COMMAND_BASE, so dispatch and length tables can be
+// indexed by (code - COMMAND_BASE); a new command must extend the block (and every
+// table built from this list) rather than leave a hole in it.
+#define PROTOCOL_COMMANDS \
+	PROTOCOL_COMMAND(HELLO_BYTE,		200, 1)	/* Indicates master is ready to talk. */ \
+	PROTOCOL_COMMAND(ID_ASSIGNMENT,		201, 1)	/* Indicates an ID assignment from the master. */ \
+	PROTOCOL_COMMAND(ID_ASSIGN_OK,		202, 1)	/* Indicates an ID assignment is complete. */ \
+	PROTOCOL_COMMAND(PING,				203, 1)	/* Indicates a ping message to or from the master. */ \
+	PROTOCOL_COMMAND(CLEAR_CONFIG,		204, 1)	/* Indicates that the master is asking for a config clear. */ \
+	PROTOCOL_COMMAND(CONFIG_CLEARED,	205, 1)	/* Indicates that a module has cleared its own config. */ \
+	PROTOCOL_COMMAND(SYNC_MOVE,			206, 1)	/* Indicates a batched sync-move frame for the whole chain. */ \
+	PROTOCOL_COMMAND(RESUME,			207, 1)	/* Indicates a warm restart from the cached identity. */ \
+	PROTOCOL_COMMAND(READ_STATS,		208, 1)	/* Asks a module for one of its performance counters. */ \
+	PROTOCOL_COMMAND(BROADCAST_ACK,		209, 1)	/* Collects one aggregated ack for a broadcast operation. */ \
+	PROTOCOL_COMMAND(TELEMETRY,			210, 1)	/* Arms or stops the autonomous position reporting. */ \
+	PROTOCOL_COMMAND(RENUMBER,			211, 1)	/* Shifts part of the chain to new IDs in place. */ \
+	PROTOCOL_COMMAND(SET_BAUD,			212, 1)	/* Moves the controller bus to a new rate tier. */ \
+	PROTOCOL_COMMAND(SWEEP_PING,		213, 1)	/* One broadcast ping; everyone answers in turn. */ \
+	PROTOCOL_COMMAND(SET_TRACE,			214, 1)	/* Arms or disarms the bus trace recorder. */ \
+	PROTOCOL_COMMAND(READ_TRACE,		215, 0)	/* Reads one entry back out of the trace ring. */ \
+	PROTOCOL_COMMAND(MEASURE,			216, 0)	/* Measures the round trip to a module's child. */ \
+	PROTOCOL_COMMAND(SET_TIMEOUT,		217, 1)	/* Programs the child response timeout period. */
+
+// Expand the list once into the command codes themselves.  COMMAND_TOP rides at the end
+// of the expansion with no code of its own, so it lands one past the last command and
+// the command count falls out of the list instead of being counted by hand.
+#define PROTOCOL_COMMAND(name, code, length)	name = (code),
+enum { PROTOCOL_COMMANDS COMMAND_TOP };
+#undef PROTOCOL_COMMAND
+
+#define		COMMAND_BASE				(HELLO_BYTE)	// The lowest controller command code.
+#define		COMMAND_COUNT				(COMMAND_TOP - COMMAND_BASE)	// How many exist.
+
+// These are the indices into the performance counter block that READ_STATS selects from
+// with its parameter byte.
+#define		STAT_TOGGLES				(0)		// How many configuration toggles have run.
+#define		STAT_CHILD_TIMEOUTS			(1)		// How many child response waits timed out.
+#define		STAT_SERVO_RETRIES			(2)		// How many pings the servo search really took.
+#define		STAT_BAD_FRAMES				(3)		// How many frames the parser threw away.
+#define		STAT_COUNT					(4)		// How many counters exist.
+
+// The aggregated acknowledgment byte is an OR of the status bits of every module at or
+// below the one reporting, so a zero ack means the whole subtree came through clean.
+#define		ACK_CHILD_SILENT			(1)		// A child somewhere below never answered the sweep.
+#define		ACK_SERVO_FAULT				(2)		// A module below is running without its servo.
+
+// A faulted module still answers hello sweeps; the fault rides the top bit of the child
+// byte, well clear of the four port numbers the low bits can carry.
+#define		HELLO_FAULT					(0b10000000)
+
+// SERVO DEFINES
+// These numbers can all be found in the AX-12+ datasheet.
+// These defines cover the range of IDs these servos are capable of.
+#define		SERVO_ID_MIN				(0)		// This is the lowest servo ID possible.
+#define		SERVO_ID_MAX				(253)	// This is the highest servo ID possible.
+// These defines are servo transmission indicators.
+#define		SERVO_START					(255)	// This is the start byte for a servo transmission.
+// These defines are used to fill in the length parameter for a given command type.  These are the only
+// lengths used by this controller for servo configuration purposes.  It is worth noting that any type
+// and length of command can be issued from the master after configuration is complete.
+#define		READ_LENGTH					(4)		// This is the length value for all reads.
+#define		WRITE_LENGTH				(4)		// This is the length value for all writes.
+#define		PING_LENGTH					(2)		// This is the length value for a ping.
+#define		RESET_LENGTH				(2)		// This is the length value for a reset.
+#define		MOVE_LENGTH					(7)		// This is the length value for a position/speed write.
+// These defines are used to fill in the servo's EEPROM address parameter for a given command type.
+#define		ID_ADDRESS					(3)		// This is the address where servo ID is stored.
+#define		STATUS_RET_ADDRESS			(16)	// This is where the status return level is stored.
+#define		GOAL_ADDRESS				(30)	// This is where goal position (then moving speed) starts.
+#define		PRESENT_POS_ADDRESS			(36)	// This is where the present position bytes live.
+// These defines are used to fill in the instruction we are using on the servo.
+#define		PING_SERVO					(1)		// This is the instruction number for ping.
+#define		READ_SERVO					(2)		// This is the instruction number for a read.
+#define		WRITE_SERVO					(3)		// This is the instruction number for a write.
+#define		RESET_SERVO					(6)		// This is the instruction to reset the servo EEPROM.
+// These defines cover all of the status return level possibilities.
+#define		STATUS_RET_NEVER			(0)		// Only respond to ping commands.
+#define		STATUS_RET_READ				(1)		// Only respond to read data commands (recommended).
+#define		STATUS_RET_ALL				(2)		// Respond to every command.
+
+#endif